@@ -1,23 +1,24 @@
 #include "runtime.h"
 #include "builtins.h"
-#include <fstream>
+#include "mapped_file.h"
 #include <iostream>
 
 //standard libraries
 #include "math.h"
+#include "vecmath.h"
 
 using namespace fastcode;
 
 bool stop = false;
 
-runtime::reference_apartment* quit_repl(const std::vector<value*> arguments, runtime::garbage_collector* gc) {
+runtime::reference_apartment* quit_repl(const std::vector<value*>& arguments, runtime::garbage_collector* gc) {
 	stop = true;
 	return gc->new_apartment(new value(VALUE_TYPE_NULL, nullptr));
 }
 
-runtime::reference_apartment* get_help(const std::vector<value*> arguments, runtime::garbage_collector* gc) {
+runtime::reference_apartment* get_help(const std::vector<value*>& arguments, runtime::garbage_collector* gc) {
 	std::cout << "Welcome to FastCode!\n\n\tIf this is your first time using FastCode, we urge you to read the documentation at https://github.com/TheRealMichaelWang/fastcode/wiki, or at least check out the section labled ,A Quick Guide, before reading the entirety of this document."<<std::endl;
-	return gc->new_apartment(new value(VALUE_TYPE_CHAR, new char(' ')));
+	return gc->new_apartment(new value(' '));
 }
 
 unsigned int code_checksum(const char* code) {
@@ -56,12 +57,33 @@ inline bool has_flag(unsigned int argc, char** argv, const char* flag) {
 	return false;
 }
 
+//gets the argument following a flag, or null if the flag wasn't passed
+inline const char* get_flag_arg(unsigned int argc, char** argv, const char* flag) {
+	for (unsigned int i = 0; i + 1 < argc; i++)
+		if (strcmp(argv[i], flag) == 0)
+			return argv[i + 1];
+	return nullptr;
+}
+
+//gets the source file, which is the first argument that isn't a flag or a flag's argument, or null if there's none so the repl is started
+inline const char* get_source_file(unsigned int argc, char** argv) {
+	for (unsigned int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "-image") == 0 || strcmp(argv[i], "-saveimage") == 0 || strcmp(argv[i], "-gcbudget") == 0)
+			i++;
+		else if (strcmp(argv[i], "-gc") != 0)
+			return argv[i];
+	}
+	return nullptr;
+}
+
 int main(unsigned int argc, char** argv) {
 	const char* working_dir = argv[0];
-	runtime::interpreter interpreter(has_flag(argc, argv, "-gc"));
+	//-gcbudget n makes major collections incremental, each step visits at most n apartments, besides marking the variables and registers that are roots
+	const char* gc_budget = get_flag_arg(argc, argv, "-gcbudget");
+	runtime::interpreter interpreter(has_flag(argc, argv, "-gc"), gc_budget == nullptr ? 0 : (unsigned int)strtoul(gc_budget, nullptr, 10));
 
-	interpreter.new_constant("pi@math", new value(VALUE_TYPE_NUMERICAL, new long double(3.1415926)));
-	interpreter.new_constant("e@math", new value(VALUE_TYPE_NUMERICAL, new long double(2.71828182)));
+	interpreter.new_constant("pi@math", new value((long double)3.1415926));
+	interpreter.new_constant("e@math", new value((long double)2.71828182));
 
 	interpreter.import_func("quit", quit_repl);
 	interpreter.import_func("help", get_help);
@@ -75,21 +97,37 @@ int main(unsigned int argc, char** argv) {
 	interpreter.import_func("atan@math", builtins::math::atan);
 	interpreter.import_func("log@math", builtins::math::log);
 
-	if (argc > 1) {
-		std::ifstream infile(argv[1], std::ifstream::binary);
+	interpreter.import_func("add@vec", builtins::vecmath::add);
+	interpreter.import_func("sub@vec", builtins::vecmath::subtract);
+	interpreter.import_func("mul@vec", builtins::vecmath::multiply);
+	interpreter.import_func("div@vec", builtins::vecmath::divide);
+	interpreter.import_func("sum@vec", builtins::vecmath::sum);
+	interpreter.import_func("min@vec", builtins::vecmath::min);
+	interpreter.import_func("max@vec", builtins::vecmath::max);
+	interpreter.import_func("dot@vec", builtins::vecmath::dot);
+	interpreter.import_func("prefix@vec", builtins::vecmath::prefix_sum);
+	interpreter.import_func("abs@vec", builtins::vecmath::abs);
+	interpreter.import_func("sqrt@vec", builtins::vecmath::sqrt);
+	interpreter.import_func("exp@vec", builtins::vecmath::exp);
+	interpreter.import_func("log@vec", builtins::vecmath::log);
+	interpreter.import_func("sin@vec", builtins::vecmath::sin);
+	interpreter.import_func("cos@vec", builtins::vecmath::cos);
+
+	//images are restored once every built in is imported, since they don't hold built ins
+	const char* boot_image = get_flag_arg(argc, argv, "-image");
+	if (boot_image != nullptr && !interpreter.load_image(boot_image)) {
+		std::cout << "Cannot load image \"" << boot_image << "\".";
+		return 1;
+	}
+
+	const char* source_file = get_source_file(argc, argv);
+	if (source_file != nullptr) {
+		parsing::mapped_file infile(source_file);
 		if (!infile.is_open()) {
-			std::cout << "Cannot open source file \"" << argv[1] << "\".";
+			std::cout << "Cannot open source file \"" << source_file << "\".";
 			return 1;
 		}
-		infile.seekg(0, std::ios::end);
-		unsigned int buffer_length = infile.tellg();
-		infile.seekg(0, std::ios::beg);
-		char* buffer = new char[buffer_length + 1];
-		infile.read(buffer, buffer_length);
-		infile.close();
-		buffer[buffer_length] = '\0';
-		long double exit_code = interpreter.run(buffer, false);
-		delete[] buffer;
+		long double exit_code = interpreter.run(infile.get_data(), infile.get_length(), false);
 		if (exit_code != 0)
 			return (int)exit_code;
 	}
@@ -121,5 +159,11 @@ int main(unsigned int argc, char** argv) {
 			delete[] buf;
 		}
 	}
+
+	const char* save_image = get_flag_arg(argc, argv, "-saveimage");
+	if (save_image != nullptr && !interpreter.save_image(save_image)) {
+		std::cout << "Cannot write image \"" << save_image << "\".";
+		return 1;
+	}
 	return 0;
 }
\ No newline at end of file
@@ -2,17 +2,20 @@
 #define BUILTINS_H
 
 #include <vector>
+#include <cstring>
 #include "errors.h"
 #include "value.h"
 #include "references.h"
 #include "collection.h"
+#include "structure.h"
+#include "table.h"
 #include "garbage.h"
 
 namespace fastcode {
 	namespace builtins {
-		typedef runtime::reference_apartment* (*built_in_function)(const std::vector<value*> arguments, runtime::garbage_collector* gc);
+		typedef runtime::reference_apartment* (*built_in_function)(const std::vector<value*>& arguments, runtime::garbage_collector* gc);
 
-		inline void match_arg_len(const std::vector<value*> arguments, unsigned int expected_size) {
+		inline void match_arg_len(const std::vector<value*>& arguments, unsigned int expected_size) {
 			if (arguments.size() != expected_size)
 				throw ERROR_UNEXPECTED_ARGUMENT_SIZE;
 		}
@@ -22,10 +25,30 @@ namespace fastcode {
 				throw ERROR_INVALID_VALUE_TYPE;
 		}
 
+		//gets the apartment an argument is stored in, objects are shared while primitives are copied into a new apartment
+		inline runtime::reference_apartment* share_arg(value* value, runtime::garbage_collector* gc) {
+			switch (value->type)
+			{
+			case VALUE_TYPE_COLLECTION:
+				return ((runtime::collection*)value->ptr)->get_parent_ref();
+			case VALUE_TYPE_STRUCT:
+				return ((runtime::structure*)value->ptr)->get_parent_ref();
+			case VALUE_TYPE_TABLE:
+				return ((runtime::table*)value->ptr)->get_parent_ref();
+			default:
+				return gc->new_apartment(value->clone());
+			}
+		}
+
 		inline char* to_c_str(value* value) {
 			match_arg_type(value, VALUE_TYPE_COLLECTION);
 			runtime::collection* collection = (class runtime::collection*)value->ptr;
 			char* c = new char[collection->size + 1];
+			if (collection->get_string() != nullptr) {
+				std::memcpy(c, collection->get_string(), collection->size);
+				c[collection->size] = 0;
+				return c;
+			}
 			for (unsigned int i = 0; i < collection->size; i++)
 			{
 				match_arg_type(collection->get_value(i), VALUE_TYPE_CHAR);
@@ -36,18 +59,48 @@ namespace fastcode {
 		}
 
 		inline runtime::collection* from_c_str(const char* str, runtime::garbage_collector* gc) {
-			runtime::collection* str_col = new runtime::collection((unsigned long)strlen(str), gc);
-			for (unsigned long i = 0; i < str_col->size; i++)
-			{
-				str_col->set_value(i, new value(VALUE_TYPE_CHAR, new char(str[i])));
-			}
-			return str_col;
+			return new runtime::collection(str, (unsigned long)strlen(str), gc);
 		}
 
-		runtime::reference_apartment* get_handle(const std::vector<value*> arguments, runtime::garbage_collector* gc); 
-		runtime::reference_apartment* set_struct_property(const std::vector<value*> arguments, runtime::garbage_collector* gc);
-		runtime::reference_apartment* abort_program(const std::vector<value*> arguments, runtime::garbage_collector* gc); 
-		runtime::reference_apartment* get_hash(const std::vector<value*> arguments, runtime::garbage_collector* gc);
+		//a string argument as a null terminated c string; strings are borrowed as is, views and any other collection of chars are converted
+		class string_arg {
+		private:
+			const char* str;
+			char* converted;
+			unsigned long length;
+
+		public:
+			explicit string_arg(value* value) {
+				match_arg_type(value, VALUE_TYPE_COLLECTION);
+				runtime::collection* collection = (runtime::collection*)value->ptr;
+				this->length = collection->size;
+				if (collection->get_string() != nullptr && !collection->is_view()) {
+					this->str = collection->get_string();
+					this->converted = nullptr;
+				}
+				else
+					this->str = this->converted = to_c_str(value);
+			}
+
+			~string_arg() {
+				delete[] this->converted;
+			}
+
+			string_arg(const string_arg&) = delete;
+
+			inline const char* c_str() {
+				return this->str;
+			}
+
+			inline unsigned long size() {
+				return this->length;
+			}
+		};
+
+		runtime::reference_apartment* get_handle(const std::vector<value*>& arguments, runtime::garbage_collector* gc); 
+		runtime::reference_apartment* set_struct_property(const std::vector<value*>& arguments, runtime::garbage_collector* gc);
+		runtime::reference_apartment* abort_program(const std::vector<value*>& arguments, runtime::garbage_collector* gc); 
+		runtime::reference_apartment* get_hash(const std::vector<value*>& arguments, runtime::garbage_collector* gc);
 	}
 }
 
@@ -0,0 +1,272 @@
+#include "errors.h"
+#include "tokens.h"
+#include "operators.h"
+#include "bytecode.h"
+
+namespace fastcode {
+	namespace parsing {
+		bytecode::bytecode(const std::vector<token*>& tokens, symbol_table* globals) {
+			this->globals = globals;
+			this->locals = globals;
+			this->statement = nullptr;
+			this->register_count = 0;
+			compile_block(tokens, nullptr);
+			this->frame_size = globals->size();
+			instructions.shrink_to_fit();
+			statements.shrink_to_fit();
+		}
+
+		bytecode::bytecode(function_prototype* prototype, symbol_table* globals) {
+			symbol_table locals;
+			this->globals = globals;
+			this->locals = &locals;
+			this->statement = nullptr;
+			this->register_count = 0;
+			for (auto it = prototype->argument_identifiers.begin(); it != prototype->argument_identifiers.end(); ++it)
+				resolve_id(*it);
+			compile_block(prototype->tokens, nullptr);
+			this->frame_size = locals.size();
+			this->locals = nullptr;
+			instructions.shrink_to_fit();
+			statements.shrink_to_fit();
+		}
+
+		token* bytecode::get_statement(const instruction* ins) const {
+			//finds the last range starting at or before the instruction
+			unsigned int index = (unsigned int)(ins - instructions.data());
+			unsigned int low = 0;
+			unsigned int high = (unsigned int)statements.size();
+			while (high - low > 1) {
+				unsigned int middle = (low + high) / 2;
+				if (statements[middle].first <= index)
+					low = middle;
+				else
+					high = middle;
+			}
+			return statements[low].statement;
+		}
+
+		void bytecode::compile_block(const std::vector<token*>& tokens, std::list<unsigned int>* break_jumps) {
+			for (auto it = tokens.begin(); it != tokens.end(); ++it)
+				compile_tok(*it, break_jumps);
+		}
+
+		void bytecode::compile_tok(token* tok, std::list<unsigned int>* break_jumps) {
+			token* enclosing = this->statement;
+			this->statement = tok;
+			switch (tok->type)
+			{
+			case TOKEN_BREAK:
+				if (break_jumps == nullptr)
+					emit(OPCODE_UNEXPECTED_BREAK, tok);
+				else
+					break_jumps->push_back(emit(OPCODE_JUMP, tok));
+				break;
+			case TOKEN_INCLUDE:
+				emit(OPCODE_INCLUDE, tok);
+				break;
+			case TOKEN_IF: {
+				std::list<unsigned int> end_jumps;
+				conditional_token* current = (conditional_token*)tok;
+				while (current != nullptr) {
+					this->statement = current;
+					if (current->condition == nullptr) {
+						compile_block(current->instructions, break_jumps);
+						break;
+					}
+					compile_expr(current->condition, 0);
+					unsigned int skip_jump = emit(OPCODE_JUMP_IF_FALSE, current, 0, 0);
+					compile_block(current->instructions, break_jumps);
+					this->statement = current;
+					if (current->next != nullptr)
+						end_jumps.push_back(emit(OPCODE_JUMP, current));
+					patch(skip_jump);
+					current = current->next;
+				}
+				for (auto it = end_jumps.begin(); it != end_jumps.end(); ++it)
+					patch(*it);
+				break;
+			}
+			case TOKEN_WHILE: {
+				std::list<unsigned int> loop_breaks;
+				unsigned int loop_start = (unsigned int)instructions.size();
+				compile_expr(((conditional_token*)tok)->condition, 0);
+				unsigned int exit_jump = emit(OPCODE_JUMP_IF_FALSE, tok, 0, 0);
+				compile_block(((conditional_token*)tok)->instructions, &loop_breaks);
+				this->statement = tok;
+				emit(OPCODE_LOOP, tok, loop_start);
+				patch(exit_jump);
+				for (auto it = loop_breaks.begin(); it != loop_breaks.end(); ++it)
+					patch(*it);
+				break;
+			}
+			case TOKEN_FOR: {
+				std::list<unsigned int> loop_breaks;
+				for_token* for_tok = (for_token*)tok;
+				resolve_id(for_tok->identifier);
+
+				//calls are left unmade, so a call to range can be streamed rather than materialized
+				if (for_tok->collection->type == TOKEN_FUNCTION_CALL) {
+					function_call_token* func_call = (function_call_token*)for_tok->collection;
+					compile_call_args(func_call, 0);
+					emit(OPCODE_FOR_BEGIN, tok, 0, (unsigned int)func_call->arguments.size(), 0, 1);
+				}
+				else {
+					compile_expr(for_tok->collection, 0);
+					emit(OPCODE_FOR_BEGIN, tok, 0);
+				}
+				unsigned int loop_next = emit(OPCODE_FOR_NEXT, tok);
+				compile_block(for_tok->instructions, &loop_breaks);
+				this->statement = tok;
+				emit(OPCODE_LOOP, tok, loop_next);
+				patch(loop_next);
+				for (auto it = loop_breaks.begin(); it != loop_breaks.end(); ++it)
+					patch(*it);
+				emit(OPCODE_FOR_END, tok);
+				break;
+			}
+			case TOKEN_UNARY_OP:
+			case TOKEN_FUNCTION_CALL:
+			case TOKEN_SET:
+				compile_expr(tok, 0);
+				break;
+			case TOKEN_RETURN:
+				compile_expr(((return_token*)tok)->value, 0);
+				emit(OPCODE_RETURN, tok, 0);
+				break;
+			case TOKEN_FUNC_PROTO: {
+				function_prototype* proto = (function_prototype*)tok;
+				if (proto->compiled == nullptr)
+					proto->compiled = new bytecode(proto, globals);
+				emit(OPCODE_DEFINE_PROC, tok);
+				break;
+			}
+			case TOKEN_STRUCT_PROTO:
+				emit(OPCODE_DEFINE_STRUCT, tok);
+				break;
+			default:
+				throw ERROR_UNEXPECTED_TOKEN;
+			}
+			this->statement = enclosing;
+		}
+
+		void bytecode::compile_expr(token* tok, unsigned int dest, unsigned char mode, unsigned int call) {
+			use_register(dest);
+			switch (tok->type)
+			{
+			case TOKEN_VALUE:
+				emit(OPCODE_LOAD_CONST, tok, dest);
+				break;
+			case TOKEN_VAR_ACCESS: {
+				variable_access_token* access = (variable_access_token*)tok;
+				if (access->modifiers.size() == 1) {
+					resolve_id(access->get_identifier());
+					emit(OPCODE_LOAD_VAR, access->get_identifier(), dest, 0, call, mode);
+					break;
+				}
+				compile_parent(access, dest);
+				token* last = access->modifiers.back();
+				if (last->type == TOKEN_IDENTIFIER)
+					emit(OPCODE_LOAD_PROPERTY, last, dest, 0, call, mode);
+				else {
+					compile_expr(((index_token*)last)->value, dest + 1);
+					emit(OPCODE_LOAD_INDEX, last, dest, dest + 1, call, mode);
+				}
+				break;
+			}
+			case TOKEN_GET_REFERENCE:
+				compile_expr(((get_reference_token*)tok)->var_access, dest, LOAD_MODE_REFERENCE);
+				break;
+			case TOKEN_CREATE_STRUCT:
+				emit(OPCODE_NEW_STRUCT, tok, dest);
+				break;
+			case TOKEN_CREATE_ARRAY: {
+				create_array_token* create_array = (create_array_token*)tok;
+				if (create_array->string != nullptr) {
+					emit(OPCODE_NEW_STRING, tok, dest);
+					break;
+				}
+				emit(OPCODE_NEW_ARRAY, tok, dest, (unsigned int)create_array->values.size());
+				for (unsigned int i = 0; i < create_array->values.size(); i++) {
+					compile_expr(create_array->values[i], dest + 1);
+					emit(OPCODE_ARRAY_SET, tok, dest, i, dest + 1);
+				}
+				break;
+			}
+			case TOKEN_SET: {
+				set_token* set_tok = (set_token*)tok;
+				compile_expr(set_tok->value, dest);
+				if (set_tok->destination->modifiers.size() == 1) {
+					resolve_id(set_tok->destination->get_identifier());
+					emit(OPCODE_STORE_VAR, set_tok->destination->get_identifier(), dest, 0, 0, set_tok->create_static);
+					break;
+				}
+				compile_parent(set_tok->destination, dest + 1);
+				token* last = set_tok->destination->modifiers.back();
+				if (last->type == TOKEN_IDENTIFIER)
+					emit(OPCODE_STORE_PROPERTY, last, dest, dest + 1);
+				else {
+					compile_expr(((index_token*)last)->value, dest + 2);
+					emit(OPCODE_STORE_INDEX, last, dest, dest + 1, dest + 2);
+				}
+				break;
+			}
+			case TOKEN_BINARY_OP: {
+				binary_operator_token* binop = (binary_operator_token*)tok;
+				compile_expr(binop->left, dest);
+				compile_expr(binop->right, dest + 1);
+				emit(OPCODE_BINARY_OP, tok, dest, dest, dest + 1, binop->op);
+				break;
+			}
+			case TOKEN_UNARY_OP: {
+				unary_operator_token* uniop = (unary_operator_token*)tok;
+
+				//an element is operated on where it is, so a packed collection isn't boxed to reference it
+				if (uniop->value->type == TOKEN_VAR_ACCESS) {
+					variable_access_token* access = (variable_access_token*)uniop->value;
+					if (access->modifiers.size() > 1 && access->modifiers.back()->type == TOKEN_INDEX) {
+						compile_parent(access, dest + 1);
+						compile_expr(((index_token*)access->modifiers.back())->value, dest + 2);
+						emit(OPCODE_UNARY_INDEX, tok, dest, dest + 1, dest + 2, uniop->op);
+						break;
+					}
+				}
+				compile_expr(uniop->value, dest, LOAD_MODE_OPERAND);
+				emit(OPCODE_UNARY_OP, tok, dest, 0, 0, uniop->op);
+				break;
+			}
+			case TOKEN_FUNCTION_CALL: {
+				function_call_token* func_call = (function_call_token*)tok;
+				compile_call_args(func_call, dest);
+				emit(OPCODE_CALL, tok, dest, (unsigned int)func_call->arguments.size());
+				break;
+			}
+			default:
+				emit(OPCODE_UNEXPECTED_TOKEN, tok, dest);
+				break;
+			}
+		}
+
+		unsigned int bytecode::compile_call_args(function_call_token* func_call, unsigned int dest) {
+			unsigned int resolve = emit(OPCODE_CALL_RESOLVE, func_call, use_register(dest));
+			for (unsigned int i = 0; i < func_call->arguments.size(); i++)
+				compile_expr(func_call->arguments[i], dest + 1 + i, LOAD_MODE_ARGUMENT, resolve);
+			return resolve;
+		}
+
+		void bytecode::compile_parent(variable_access_token* access, unsigned int dest) {
+			resolve_id(access->get_identifier());
+			emit(OPCODE_LOAD_VAR, access->get_identifier(), use_register(dest), 0, 0, LOAD_MODE_REFERENCE);
+			unsigned int last = (unsigned int)access->modifiers.size() - 1;
+			for (unsigned int i = 1; i < last; i++) {
+				token* modifier = access->modifiers[i];
+				if (modifier->type == TOKEN_IDENTIFIER)
+					emit(OPCODE_LOAD_PROPERTY, modifier, dest, 0, 0, LOAD_MODE_REFERENCE);
+				else {
+					compile_expr(((index_token*)modifier)->value, dest + 1);
+					emit(OPCODE_LOAD_INDEX, modifier, dest, dest + 1);
+				}
+			}
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,203 @@
+#pragma once
+
+#ifndef BYTECODE_H
+#define BYTECODE_H
+
+#include <list>
+#include <vector>
+#include <unordered_map>
+#include "tokens.h"
+
+//instructions read and write registers, a frame's temporaries, which are numbered from the frame's first register
+//a is an instruction's destination register or jump target, b and c are it's source registers or other operands
+
+//load instructions, their op is a load mode
+#define OPCODE_LOAD_CONST 0 //copies a value token's value into a
+#define OPCODE_LOAD_VAR 1 //loads a variable into a
+#define OPCODE_LOAD_PROPERTY 2 //replaces the struct in a with one of it's properties
+#define OPCODE_LOAD_INDEX 3 //replaces the collection in a with it's element at the index in b
+
+//store instructions
+#define OPCODE_STORE_VAR 4 //stores a into a variable, declaring it if it doesn't exist; a non-zero op declares a static
+#define OPCODE_STORE_PROPERTY 5 //stores a into a property of the struct in b
+#define OPCODE_STORE_INDEX 6 //stores a into the element of the collection in b, at the index in c
+
+//operator instructions
+#define OPCODE_BINARY_OP 7 //applies op to b and c, storing the result in a
+#define OPCODE_UNARY_OP 8 //applies op to a, which may be a reference that's modified in place, and replaces it with the result
+#define OPCODE_UNARY_INDEX 9 //applies op in place to the element of the collection in b at the index in c, storing the result in a
+
+//object instructions
+#define OPCODE_NEW_STRUCT 10 //creates a struct in a
+#define OPCODE_NEW_STRING 11 //creates a string literal in a
+#define OPCODE_NEW_ARRAY 12 //creates an array of b elements in a
+#define OPCODE_ARRAY_SET 13 //sets the element of the new array in a at the index b to c
+
+//call instructions, a call's arguments are loaded into the registers following it's destination
+#define OPCODE_CALL_RESOLVE 14 //resolves a call, it must precede the call's arguments since they're loaded differently for procedures and built ins
+#define OPCODE_CALL 15 //calls a procedure or built in with b arguments, storing the result in a
+
+//control flow instructions
+#define OPCODE_RETURN 16 //returns a from the block
+#define OPCODE_JUMP 17 //jumps to a
+#define OPCODE_JUMP_IF_FALSE 18 //jumps to a if b is false
+#define OPCODE_LOOP 19 //jumps back to a, the start of a loop
+#define OPCODE_FOR_BEGIN 20 //pushes an iterator over the collection in a; a non-zero op means a holds an unmade call with b arguments instead, so a range can be streamed
+#define OPCODE_FOR_NEXT 21 //binds the next element to the loop variable, or jumps to a when there are none left
+#define OPCODE_FOR_END 22 //pops a for loop's iterator and removes it's loop variable
+#define OPCODE_UNEXPECTED_BREAK 23 //a break statement outside of a loop
+#define OPCODE_UNEXPECTED_TOKEN 24 //a token that can't be evaluated
+
+//top level instructions
+#define OPCODE_INCLUDE 25
+#define OPCODE_DEFINE_PROC 26
+#define OPCODE_DEFINE_STRUCT 27
+
+//how a load instruction loads it's value
+#define LOAD_MODE_VALUE 0 //primitives are copied, objects are referenced
+#define LOAD_MODE_REFERENCE 1 //always references the value's apartment
+#define LOAD_MODE_ARGUMENT 2 //a call's argument, referenced for procedures, which are lent packed elements, and copied for built ins; c is the call's resolve instruction
+#define LOAD_MODE_OPERAND 3 //referenced only while an operator modifies it in place
+
+namespace fastcode {
+	namespace parsing {
+		struct instruction {
+			unsigned char opcode;
+
+			//an operator or load mode
+			unsigned char op;
+			unsigned int a;
+			unsigned int b;
+			unsigned int c;
+
+			//the token an instruction takes it's identifier, constant or call from
+			token* tok;
+		};
+
+		//maps variable identifiers to dense slot indices
+		class symbol_table {
+		private:
+			std::unordered_map<unsigned int, unsigned int> slots;
+
+			//the symbol of each slot, in slot order
+			std::vector<unsigned int> symbols;
+
+		public:
+			//gets an identifier's slot, assigning the next free one if it doesn't have one yet
+			inline unsigned int resolve(unsigned int symbol_id) {
+				auto it = slots.find(symbol_id);
+				if (it != slots.end())
+					return it->second;
+				unsigned int slot = (unsigned int)slots.size();
+				slots[symbol_id] = slot;
+				symbols.push_back(symbol_id);
+				return slot;
+			}
+
+			inline unsigned int get_symbol(unsigned int slot) {
+				return symbols[slot];
+			}
+
+			inline unsigned int size() {
+				return (unsigned int)slots.size();
+			}
+		};
+
+		//a flat, linear instruction stream lowered from a block of top level tokens, whose expressions are lowered to register instructions
+		class bytecode {
+		private:
+			std::vector<instruction> instructions;
+
+			//the statement instructions were lowered from, which is reported when one throws an error
+			//consecutive instructions of the same statement share a range, which starts at it's first instruction
+			struct statement_range {
+				unsigned int first;
+				token* statement;
+			};
+			std::vector<statement_range> statements;
+			token* statement;
+
+			//module level symbols, used for statics and top level variables
+			symbol_table* globals;
+
+			//symbols of the frame the code runs in, the same as globals for top level code
+			symbol_table* locals;
+
+			unsigned int frame_size;
+			unsigned int register_count;
+
+
+			inline unsigned int emit(unsigned char opcode, token* tok, unsigned int a = 0, unsigned int b = 0, unsigned int c = 0, unsigned char op = 0) {
+				instruction ins;
+				ins.opcode = opcode;
+				ins.op = op;
+				ins.a = a;
+				ins.b = b;
+				ins.c = c;
+				ins.tok = tok;
+				instructions.push_back(ins);
+				if (statements.empty() || statements.back().statement != statement)
+					statements.push_back({ (unsigned int)instructions.size() - 1, statement });
+				return (unsigned int)instructions.size() - 1;
+			}
+
+			//sets a previously emitted jump's target to the next instruction
+			inline void patch(unsigned int jump) {
+				instructions[jump].a = (unsigned int)instructions.size();
+			}
+
+			//claims a register, registers above an expression's destination are free for it's temporaries
+			inline unsigned int use_register(unsigned int reg) {
+				if (reg >= register_count)
+					register_count = reg + 1;
+				return reg;
+			}
+
+			void compile_block(const std::vector<token*>& tokens, std::list<unsigned int>* break_jumps);
+			void compile_tok(token* tok, std::list<unsigned int>* break_jumps);
+
+			//lowers an expression, leaving it's result in dest
+			void compile_expr(token* tok, unsigned int dest, unsigned char mode = LOAD_MODE_VALUE, unsigned int call = 0);
+
+			//lowers a call up to and including it's arguments, returns the call's resolve instruction
+			unsigned int compile_call_args(function_call_token* func_call, unsigned int dest);
+
+			//loads the variable an access starts from and applies every modifier but the last, leaving a reference in dest
+			void compile_parent(variable_access_token* access, unsigned int dest);
+
+			inline void resolve_id(identifier_token* identifier) {
+				identifier->slot = locals->resolve(identifier->symbol_id);
+				identifier->static_slot = globals->resolve(identifier->symbol_id);
+			}
+
+		public:
+			//compiles top level code, whose variables live in the module level frame
+			bytecode(const std::vector<token*>& tokens, symbol_table* globals);
+
+			//compiles a procedure's body, whose arguments and variables live in it's own frame
+			bytecode(function_prototype* prototype, symbol_table* globals);
+
+			//the amount of variable slots a frame running this code needs
+			inline unsigned int get_frame_size() const {
+				return this->frame_size;
+			}
+
+			//the amount of registers a frame running this code needs
+			inline unsigned int get_register_count() const {
+				return this->register_count;
+			}
+
+			inline const instruction* begin() const {
+				return instructions.data();
+			}
+
+			inline const instruction* end() const {
+				return instructions.data() + instructions.size();
+			}
+
+			token* get_statement(const instruction* ins) const;
+		};
+	}
+}
+
+#endif // !BYTECODE_H
\ No newline at end of file
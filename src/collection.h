@@ -3,42 +3,269 @@
 #ifndef COLLECTION_H
 #define COLLECTION_H
 
+#include <utility>
+#include "errors.h"
 #include "references.h"
 #include "garbage.h"
 #include "value.h"
 
+//the least amount of elements a growing collection reserves
+#define COLLECTION_MIN_CAPACITY 4
+
 namespace fastcode {
 	namespace runtime {
+		//a growable array of elements; collections start out packed, holding primitive elements inline without any apartments
+		//an element is boxed into an apartment of it's own once it's referenced, while the rest of the collection stays packed
+		//the whole collection is boxed into an array of apartments once a non-primitive value is stored
+		//strings are packed even further, as contiguous, null terminated bytes, until a non-char element is stored
+		//a view is a slice of another collection, it has no storage of it's own and forwards every element access to it's viewed collection
 		class collection {
 		private:
 			reference_apartment* parent_reference;
 			reference_apartment** inner_collection;
-			collection(unsigned long size, reference_apartment* parent_reference);
+			value* packed_collection;
+			char* string;
+
+			//the amount of elements the active storage has room for, at least size
+			unsigned long capacity;
+			garbage_collector* gc;
+
+			//a string's hash is cached until it's modified
+			int string_hash;
+			bool string_hashed;
+
+			//the apartment of the collection a view slices, it's the view's only child so the collector keeps it alive
+			//a view aliases the apartment, so if another collection is assigned to it the view slices that one instead
+			reference_apartment* viewed_reference;
+			unsigned long view_offset;
+
+			inline collection* get_viewed() {
+				value* viewed_value = this->viewed_reference->value;
+				if (viewed_value->type != VALUE_TYPE_COLLECTION || viewed_value->ptr == this)
+					throw ERROR_INVALID_VALUE_TYPE;
+				return (collection*)viewed_value->ptr;
+			}
+
+			//maps an index into a view to an index into the viewed collection, which may have shrunk since the view was made
+			inline unsigned long view_index(collection* viewed, unsigned long index) {
+				if (this->view_offset + index >= viewed->size)
+					throw ERROR_INDEX_OUT_OF_RANGE;
+				return this->view_offset + index;
+			}
+
+			collection(unsigned long size, reference_apartment* parent_reference, garbage_collector* gc);
+
+			//unpacks a string's bytes into packed char values
+			void widen();
+
+			//gives every packed element it's own apartment
+			void box();
+
+			//gives a single packed element it's own apartment, a packed element's apartment is null
+			//the apartment isn't recorded by the write barrier, that's left to whoever the element's boxed for
+			reference_apartment* box(unsigned long index);
+
+			//whether an element is held inline in the packed storage
+			inline bool packs(unsigned long index) {
+				return this->packed_collection != nullptr && (this->inner_collection == nullptr || this->inner_collection[index] == nullptr);
+			}
+
+			//doubles the storage once it's full
+			inline void grow() {
+				if (this->size == this->capacity)
+					reserve(this->capacity < COLLECTION_MIN_CAPACITY ? COLLECTION_MIN_CAPACITY : this->capacity * 2);
+			}
 
 		public:
 			unsigned long size;
 			collection(unsigned long size, garbage_collector* gc);
 			collection(collection* a, collection* b, reference_apartment* parent_reference);
+
+			//creates a string, copying length bytes
+			collection(const char* string, unsigned long length, garbage_collector* gc);
+
+			//creates a view of length elements of another collection, starting at offset
+			collection(collection* viewed, unsigned long offset, unsigned long length);
 			~collection();
+
+			//collection headers are allocated from a shared slab, their elements are not
+			static void* operator new(std::size_t size);
+			static void operator delete(void* ptr, std::size_t size);
+
+			inline bool is_packed() {
+				if (this->viewed_reference != nullptr)
+					return get_viewed()->is_packed();
+				return this->inner_collection == nullptr;
+			}
+
+			//whether an element is held inline, without an apartment
+			inline bool is_element_packed(unsigned long index) {
+				if (this->viewed_reference != nullptr) {
+					collection* viewed = get_viewed();
+					return viewed->is_element_packed(view_index(viewed, index));
+				}
+				return this->inner_collection == nullptr || this->inner_collection[index] == nullptr;
+			}
+
+			inline bool is_view() {
+				return this->viewed_reference != nullptr;
+			}
+
+			//gets a string's bytes, or null if the collection isn't a string; they're null terminated unless the collection is a view
+			inline const char* get_string() {
+				if (this->viewed_reference != nullptr) {
+					collection* viewed = get_viewed();
+					const char* viewed_string = viewed->get_string();
+					if (viewed_string == nullptr || this->view_offset + this->size > viewed->size)
+						return nullptr;
+					return viewed_string + this->view_offset;
+				}
+				return this->string;
+			}
+
+			//appends bytes to the end of a string, growing it's buffer geometrically; do not call unless the collection is a string, and not a view
+			void append_string(const char* bytes, unsigned long length);
+
+			//reallocates the storage to fit at least new_capacity elements, without changing the size
+			void reserve(unsigned long new_capacity);
+
+			//appends an element, taking ownership of it's value
+			void push(value* element);
+
+			//appends an element that shares an existing apartment
+			void push_reference(reference_apartment* reference);
+
+			//removes the last element, returning it's apartment; do not call on an empty collection
+			reference_apartment* pop();
+
+			//moves the last element to an index, shifting the elements from that index onwards back by one
+			void move_last(unsigned long index);
+
+			//removes an element, shifting the elements after it forward, and returns it's apartment
+			reference_apartment* remove(unsigned long index);
+
+			//copies a packed element
+			inline value get_packed(unsigned long index) {
+				if (this->viewed_reference != nullptr) {
+					collection* viewed = get_viewed();
+					return viewed->get_packed(view_index(viewed, index));
+				}
+				if (this->string != nullptr)
+					return value(this->string[index]);
+				return this->packed_collection[index].copy();
+			}
+
 			inline void set_reference(unsigned long index, reference_apartment* reference) {
-				this->inner_collection[index]->remove_parent_references(parent_reference);
-				reference->add_parent_references(parent_reference);
+				if (this->viewed_reference != nullptr) {
+					collection* viewed = get_viewed();
+					viewed->set_reference(view_index(viewed, index), reference);
+					return;
+				}
+				if (this->inner_collection == nullptr || this->packed_collection != nullptr)
+					box();
+				gc->write_barrier(parent_reference, reference);
 				this->inner_collection[index] = reference;
 			}
 
-			inline reference_apartment* get_reference(unsigned long index) {
+			//lends an element's apartment to a single variable, boxing only that element if it's packed, an element that was already boxed is shared instead
+			//the borrower keeps the apartment alive, and must call unbox once it's done with it, so the collection's parent isn't remembered for every element that's lent
+			inline reference_apartment* lend(unsigned long index) {
+				if (this->viewed_reference != nullptr) {
+					collection* viewed = get_viewed();
+					return viewed->lend(view_index(viewed, index));
+				}
+				if (this->inner_collection == nullptr || this->inner_collection[index] == nullptr)
+					return box(index);
+				this->inner_collection[index]->share();
 				return this->inner_collection[index];
 			}
 
+			//gets an element's apartment, boxing the element if it's packed
+			inline reference_apartment* get_reference(unsigned long index) {
+				if (this->viewed_reference != nullptr) {
+					collection* viewed = get_viewed();
+					return viewed->get_reference(view_index(viewed, index));
+				}
+				reference_apartment* reference;
+				if (this->inner_collection == nullptr || this->inner_collection[index] == nullptr) {
+					reference = box(index);
+					gc->write_barrier(parent_reference, reference);
+				}
+				else
+					reference = this->inner_collection[index];
+				reference->share();
+				return reference;
+			}
+
+			//returns a lent element to the packed storage, unless it's apartment has been shared or the element has been replaced since
+			//an element that stays boxed is recorded by the write barrier, since it's borrower won't keep it alive anymore
+			void unbox(unsigned long index, reference_apartment* reference);
+
+			//sets an element's value, taking ownership of it
 			inline void set_value(unsigned long index, value* value) {
-				get_reference(index)->set_value(value);
+				if (this->viewed_reference != nullptr) {
+					collection* viewed = get_viewed();
+					viewed->set_value(view_index(viewed, index), value);
+					return;
+				}
+				if (this->string != nullptr && value->type == VALUE_TYPE_CHAR) {
+					this->string[index] = value->character;
+					this->string_hashed = false;
+					delete value;
+					return;
+				}
+				if (this->string != nullptr)
+					widen();
+				if (this->packed_collection != nullptr && !value->is_primitive())
+					box();
+				if (packs(index)) {
+					this->packed_collection[index] = std::move(*value);
+					delete value;
+				}
+				else
+					this->inner_collection[index]->set_value(value);
+			}
+
+			//sets an element to a copy of a primitive value
+			inline void set_primitive(unsigned long index, value* value) {
+				if (this->viewed_reference != nullptr) {
+					collection* viewed = get_viewed();
+					viewed->set_primitive(view_index(viewed, index), value);
+					return;
+				}
+				if (this->string != nullptr && value->type == VALUE_TYPE_CHAR) {
+					this->string[index] = value->character;
+					this->string_hashed = false;
+					return;
+				}
+				if (this->string != nullptr)
+					widen();
+				if (packs(index))
+					this->packed_collection[index] = value->copy();
+				else
+					this->inner_collection[index]->set_primitive(value);
 			}
 
+			//gets a pointer to an element's value, strings are widened to packed values first
 			inline value* get_value(unsigned long index) {
-				return get_reference(index)->value;
+				if (this->viewed_reference != nullptr) {
+					collection* viewed = get_viewed();
+					return viewed->get_value(view_index(viewed, index));
+				}
+				if (this->string != nullptr)
+					widen();
+				if (packs(index))
+					return &this->packed_collection[index];
+				return this->inner_collection[index]->value;
 			}
 
-			inline reference_apartment** get_children() {
+			//gets the element apartments the collector traces, or the viewed collection's apartment for a view; packed elements are null
+			inline reference_apartment** get_children(unsigned int* children_size) {
+				if (this->viewed_reference != nullptr) {
+					*children_size = 1;
+					return &this->viewed_reference;
+				}
+				*children_size = this->size;
 				return this->inner_collection;
 			}
 
@@ -1,59 +1,248 @@
+#include <new>
 #include "garbage.h"
 
 namespace fastcode {
 	namespace runtime {
-		garbage_collector::garbage_collector() {
-			this->size = 0;
-			this->head = nullptr;
-			this->tail = nullptr;
-			this->sweep_frames = std::stack<reference_apartment*>();
+		garbage_collector::garbage_collector(unsigned int nursery_size, unsigned int step_budget) : apartment_slab(sizeof(reference_apartment)) {
+			this->young_head = nullptr;
+			this->old_head = nullptr;
+			this->young_size = 0;
+			this->old_size = 0;
+			this->major_threshold = GC_MIN_MAJOR_THRESHOLD;
+			this->nursery_size = nursery_size;
+			this->major = false;
+			this->step_budget = step_budget;
+			this->phase = GC_PHASE_IDLE;
+			this->remarking = false;
+			this->scan_cursor = nullptr;
+			this->scanning_old = false;
+			this->sweep_young = nullptr;
+			this->sweep_old = nullptr;
 		}
 
 		garbage_collector::~garbage_collector() {
-			while (size > 0)
-			{
-				sweep(true);
+			reference_apartment* heads[4] = { young_head, old_head, sweep_young, sweep_old };
+			for (int i = 0; i < 4; i++) {
+				reference_apartment* current = heads[i];
+				while (current != nullptr)
+				{
+					reference_apartment* to_delete = current;
+					current = current->next_apartment;
+					destroy(to_delete);
+				}
 			}
 		}
 
 		reference_apartment* garbage_collector::new_apartment(value* initial_value) {
-			if (size == 0) {
-				size++;
-				return (tail = (head = new reference_apartment(initial_value)));
+			young_size++;
+			young_head = new (apartment_slab.allocate()) reference_apartment(initial_value, young_head);
+
+			//apartments allocated while incrementally marking are kept alive, and are promoted along with everything else that survives
+			if (phase == GC_PHASE_MARK)
+				young_head->marked = young_head->old = true;
+			return young_head;
+		}
+
+		bool garbage_collector::begin_collection(bool force_major) {
+			switch (phase)
+			{
+			case GC_PHASE_IDLE:
+				this->major = force_major || old_size >= major_threshold;
+				if (this->major && this->step_budget > 0) {
+					phase = GC_PHASE_MARK;
+					remarking = false;
+					scan_cursor = young_head;
+					scanning_old = false;
+				}
+				return true;
+			case GC_PHASE_MARK:
+				//variables aren't guarded by barriers, so their roots are marked again whenever marking runs dry
+				remarking = mark_stack.empty() && scanning_old && scan_cursor == nullptr;
+				return remarking;
+			default:
+				return false;
 			}
-			else {
-				size++;
-				tail->next_apartment = new reference_apartment(initial_value);
-				tail = tail->next_apartment;
-				return tail;
+		}
+
+		void garbage_collector::drain_mark_stack() {
+			while (!mark_stack.empty())
+			{
+				reference_apartment* current = mark_stack.back();
+				mark_stack.pop_back();
+				unsigned int children_size = 0;
+				reference_apartment** children = current->get_children(&children_size);
+				if (children == nullptr)
+					continue;
+				for (unsigned int i = 0; i < children_size; i++)
+					shade(children[i]);
 			}
 		}
 
-		unsigned int garbage_collector::sweep(bool pop_frame) {
+		void garbage_collector::mark(reference_apartment* root) {
+			shade(root);
+			if (phase != GC_PHASE_MARK)
+				drain_mark_stack();
+		}
+
+		unsigned int garbage_collector::sweep_generation(reference_apartment** head, bool promote) {
 			unsigned int destroyed_values = 0;
-			reference_apartment* current = sweep_frames.empty() ? head : sweep_frames.top()->next_apartment;
-			reference_apartment* previous = sweep_frames.empty() ? nullptr : sweep_frames.top();
+			reference_apartment* current = *head;
+			reference_apartment* previous = nullptr;
 			while (current != nullptr)
 			{
-				if (current->can_delete()) {
-					reference_apartment* to_delete = current;
-					current = current->next_apartment;
+				reference_apartment* next = current->next_apartment;
+				if (!current->marked) {
 					if (previous == nullptr)
-						head = current;
+						*head = next;
 					else
-						previous->next_apartment = current;
-					delete to_delete;
-					size--;
+						previous->next_apartment = next;
+					destroy(current);
 					destroyed_values++;
 				}
+				else if (promote) {
+					if (previous == nullptr)
+						*head = next;
+					else
+						previous->next_apartment = next;
+					current->marked = false;
+					current->old = true;
+					current->next_apartment = old_head;
+					old_head = current;
+					old_size++;
+				}
 				else {
+					current->marked = false;
 					previous = current;
-					current = current->next_apartment;
 				}
+				current = next;
+			}
+			return destroyed_values;
+		}
+
+		void garbage_collector::clear_remembered() {
+			for (auto it = remembered.begin(); it != remembered.end(); ++it)
+				(*it)->remembered = false;
+			remembered.clear();
+		}
+
+		unsigned int garbage_collector::step() {
+			unsigned int budget = step_budget;
+			if (phase == GC_PHASE_MARK) {
+				if (remarking) {
+					remarking = false;
+
+					//roots that weren't marked yet are traced by the following steps, and then the roots are marked again
+					//once every root has already been marked, everything reachable has been traced, so everything unmarked is garbage
+					//both generations are detached to be swept, new apartments start a fresh nursery
+					if (!mark_stack.empty())
+						return 0;
+					clear_remembered();
+					sweep_old = old_head;
+					sweep_young = young_head;
+					old_head = young_head = nullptr;
+					old_size = young_size = 0;
+					phase = GC_PHASE_SWEEP;
+					return 0;
+				}
+
+				//pinned apartments are roots, apartments pinned after they're scanned are marked by the pin barrier
+				while (budget > 0 && scan_cursor != nullptr)
+				{
+					if (scan_cursor->pins > 0)
+						shade(scan_cursor);
+					scan_cursor = scan_cursor->next_apartment;
+					if (scan_cursor == nullptr && !scanning_old) {
+						scan_cursor = old_head;
+						scanning_old = true;
+					}
+					budget--;
+				}
+				if (scan_cursor == nullptr)
+					scanning_old = true;
+
+				while (budget > 0 && !mark_stack.empty())
+				{
+					reference_apartment* current = mark_stack.back();
+					mark_stack.pop_back();
+					unsigned int children_size = 0;
+					reference_apartment** children = current->get_children(&children_size);
+					if (children != nullptr) {
+						for (unsigned int i = 0; i < children_size; i++)
+							shade(children[i]);
+					}
+					budget--;
+				}
+				return 0;
+			}
+
+			unsigned int destroyed_values = 0;
+			while (budget > 0 && (sweep_old != nullptr || sweep_young != nullptr))
+			{
+				reference_apartment* current;
+				if (sweep_old != nullptr) {
+					current = sweep_old;
+					sweep_old = current->next_apartment;
+				}
+				else {
+					current = sweep_young;
+					sweep_young = current->next_apartment;
+				}
+
+				if (!current->marked) {
+					destroy(current);
+					destroyed_values++;
+				}
+				else {
+					current->marked = false;
+					current->old = true;
+					current->next_apartment = old_head;
+					old_head = current;
+					old_size++;
+				}
+				budget--;
+			}
+
+			if (sweep_old == nullptr && sweep_young == nullptr) {
+				major_threshold = old_size * 2 > GC_MIN_MAJOR_THRESHOLD ? old_size * 2 : GC_MIN_MAJOR_THRESHOLD;
+				major = false;
+				phase = GC_PHASE_IDLE;
+			}
+			return destroyed_values;
+		}
+
+		unsigned int garbage_collector::sweep() {
+			if (phase != GC_PHASE_IDLE)
+				return step();
+
+			//pinned apartments are roots, and so are the children of remembered old apartments during a minor collection
+			for (reference_apartment* current = young_head; current != nullptr; current = current->next_apartment)
+				if (current->pins > 0)
+					mark(current);
+			if (major) {
+				for (reference_apartment* current = old_head; current != nullptr; current = current->next_apartment)
+					if (current->pins > 0)
+						mark(current);
+			}
+			else {
+				for (auto it = remembered.begin(); it != remembered.end(); ++it) {
+					mark_stack.push_back(*it);
+					drain_mark_stack();
+				}
+			}
+			clear_remembered();
+
+			unsigned int destroyed_values = 0;
+			if (major) {
+				unsigned int old_destroyed = sweep_generation(&old_head, false);
+				old_size -= old_destroyed;
+				destroyed_values += old_destroyed;
+
+				//collect the old generation again once it has doubled
+				major_threshold = old_size * 2 > GC_MIN_MAJOR_THRESHOLD ? old_size * 2 : GC_MIN_MAJOR_THRESHOLD;
 			}
-			tail = previous;
-			if (!sweep_frames.empty() && pop_frame)
-				sweep_frames.pop();
+			destroyed_values += sweep_generation(&young_head, true);
+			young_size = 0;
+			major = false;
 			return destroyed_values;
 		}
 	}
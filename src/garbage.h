@@ -3,33 +3,134 @@
 #ifndef GARBAGE_H
 #define GARBAGE_H
 
-#include <stack>
+#include <vector>
 #include "references.h"
+#include "slab.h"
+
+//the amount of young apartments that triggers a minor collection
+#define GC_NURSERY_SIZE 4096
+
+//a smaller nursery, used when garbage is collected eagerly
+#define GC_EAGER_NURSERY_SIZE 256
+
+//the minimum size of the old generation before a major collection
+#define GC_MIN_MAJOR_THRESHOLD 65536
+
+//phases of an incremental major collection
+#define GC_PHASE_IDLE 0
+#define GC_PHASE_MARK 1
+#define GC_PHASE_SWEEP 2
 
 namespace fastcode {
 	namespace runtime {
+		//a generational, tracing mark-sweep collector; the owner marks it's roots, then sweeps away everything unmarked
+		//new apartments start in the nursery, and minor collections promote survivors to the old generation without touching it
+		//given a step budget, major collections are incremental, and are spread across many steps that each visit at most budget apartments
+		//only marking the roots themselves isn't budgeted, they're marked again whenever marking runs dry, and marking is finished once they're all marked already
 		class garbage_collector {
 		private:
-			unsigned int size;
-			reference_apartment* head;
-			reference_apartment* tail;
-			std::stack<reference_apartment*> sweep_frames;
+			reference_apartment* young_head;
+			reference_apartment* old_head;
+			unsigned int young_size;
+			unsigned int old_size;
+			unsigned int major_threshold;
+			unsigned int nursery_size;
+			bool major;
 
-		public:
-			garbage_collector();
-			~garbage_collector();
+			//the maximum amount of apartments visited by an incremental step, zero if collections are never incremental
+			unsigned int step_budget;
+			char phase;
+
+			//set once incremental marking runs dry, and the roots must be marked again to finish it
+			bool remarking;
+
+			//the next apartment to check for pins, while incrementally marking
+			reference_apartment* scan_cursor;
+			bool scanning_old;
 
-			//initializes a new garbage collection frame
-			inline void new_frame() {
-				if (tail != nullptr)
-					this->sweep_frames.push(tail);
+			//apartments detached for an incremental sweep, survivors are moved back into the old generation
+			reference_apartment* sweep_young;
+			reference_apartment* sweep_old;
+
+			//apartments are carved from the collector's own slab, and swept apartments are recycled through it
+			slab apartment_slab;
+
+			inline void destroy(reference_apartment* apartment) {
+				apartment->~reference_apartment();
+				apartment_slab.release(apartment);
+			}
+
+			//old apartments that may reference young apartments, they are roots of a minor collection
+			std::vector<reference_apartment*> remembered;
+			std::vector<reference_apartment*> mark_stack;
+
+			//whether an apartment is collected by the current collection
+			inline bool collecting(reference_apartment* apartment) {
+				return this->major || !apartment->old;
+			}
+
+			//marks an apartment without tracing it's children yet, the children of a partly boxed collection include nulls for it's packed elements
+			//while incrementally marking, marked apartments are promoted right away, so the write barrier remembers their young children
+			inline void shade(reference_apartment* apartment) {
+				if (apartment != nullptr && !apartment->marked && collecting(apartment)) {
+					apartment->marked = true;
+					if (this->phase == GC_PHASE_MARK)
+						apartment->old = true;
+					mark_stack.push_back(apartment);
+				}
 			}
 
+			void drain_mark_stack();
+
+			//frees every unmarked apartment in a generation, returns the amount of apartments destroyed
+			unsigned int sweep_generation(reference_apartment** head, bool promote);
+
+			void clear_remembered();
+
+			//performs one budgeted step of an incremental major collection
+			unsigned int step();
+
+		public:
+			garbage_collector(unsigned int nursery_size = GC_NURSERY_SIZE, unsigned int step_budget = 0);
+			~garbage_collector();
+
 			//creates a new variable apartment within the garbage collector
 			reference_apartment* new_apartment(value* initial_value);
 
-			//de-allocates unused variable appartments within the current garbage collection frame
-			unsigned int sweep(bool pop_frame);
+			//checks whether the nursery has filled up enough to warrant a collection, or if an incremental collection is underway
+			inline bool should_collect() {
+				return this->phase != GC_PHASE_IDLE || this->young_size >= this->nursery_size;
+			}
+
+			//records a reference stored into a parent, remembering old parents that gain young children
+			inline void write_barrier(reference_apartment* parent, reference_apartment* child) {
+				if (parent->old && !child->old && !parent->remembered) {
+					parent->remembered = true;
+					remembered.push_back(parent);
+				}
+
+				//an already traced parent won't be traced again during incremental marking
+				if (this->phase == GC_PHASE_MARK)
+					shade(child);
+			}
+
+			//pins an apartment, so it's kept alive while it's in use
+			inline void pin(reference_apartment* apartment) {
+				apartment->pin();
+				if (this->phase == GC_PHASE_MARK)
+					shade(apartment);
+			}
+
+			//starts a new collection, a major one if the old generation has outgrown it's threshold, or resumes an incremental one
+			//returns whether the owner must mark it's roots
+			bool begin_collection(bool force_major = false);
+
+			//marks an apartment and everything reachable from it as alive
+			void mark(reference_apartment* root);
+
+			//de-allocates every unmarked, unpinned apartment and promotes surviving young apartments
+			//only a single budgeted step is taken while collecting incrementally
+			unsigned int sweep();
 		};
 	}
 }
@@ -2,8 +2,12 @@
 #include <iostream>
 
 unsigned long insecure_hash(const char* str){
+	return insecure_hash(str, (unsigned long)std::strlen(str));
+}
+
+unsigned long insecure_hash(const char* str, unsigned long length) {
 	unsigned long hash = 5381;
-	for (int i = std::strlen(str) - 1; i >= 0; i--)
+	for (long i = (long)length - 1; i >= 0; i--)
 	{
 		hash = ((hash << 5) + hash) + str[i];
 	}
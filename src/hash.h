@@ -6,9 +6,30 @@
 //don't use to hash sensitive data
 unsigned long insecure_hash(const char* str);
 
-//also an insecure hash
+//hashes length chars, the string doesn't have to be null terminated
+unsigned long insecure_hash(const char* str, unsigned long length);
+
+//computes the same hash as insecure_hash one char at a time, from the first char to the last
+//the hash is folded from the last char, so each char is weighed by the next power of 33 instead
+struct insecure_hasher {
+	unsigned long sum = 0;
+	unsigned long power = 1;
+
+	inline void push(char c) {
+		sum += c * power;
+		power *= 33;
+	}
+
+	inline unsigned long hash() {
+		return 5381 * power + sum;
+	}
+};
+
+//also an insecure hash, a step of fnv-1a that folds in a whole hash rather than a byte
+//the shift carries the high bits of the product back down, so every hash folded in affects every bit of the result
 inline int combine_hash(int hash_a, int hash_b) {
-	return (hash_a << 5) + hash_b;
+	unsigned int hash = ((unsigned int)hash_a ^ (unsigned int)hash_b) * 16777619u;
+	return (int)(hash ^ (hash >> 15));
 }
 
 #endif // !DJ2B_H
\ No newline at end of file
@@ -0,0 +1,109 @@
+#include "builtins.h"
+#include "structure.h"
+#include "collection.h"
+#include "table.h"
+#include "hashtable.h"
+
+namespace fastcode {
+	namespace builtins {
+		namespace hashtable {
+			inline runtime::table* table_arg(value* value, bool map) {
+				match_arg_type(value, VALUE_TYPE_TABLE);
+				runtime::table* table = (runtime::table*)value->ptr;
+				if (table->is_map() != map)
+					throw ERROR_INVALID_VALUE_TYPE;
+				return table;
+			}
+
+			//stores an element of a key or value listing, primitives are copied so the table can't be modified through the listing
+			static void set_element(runtime::collection* collection, unsigned int index, runtime::reference_apartment* element) {
+				if (element->value->is_primitive())
+					collection->set_primitive(index, element->value);
+				else
+					collection->set_reference(index, element);
+			}
+
+			runtime::reference_apartment* new_map(const std::vector<value*>& arguments, runtime::garbage_collector* gc) {
+				match_arg_len(arguments, 0);
+				return (new runtime::table(true, gc))->get_parent_ref();
+			}
+
+			runtime::reference_apartment* map_set(const std::vector<value*>& arguments, runtime::garbage_collector* gc) {
+				match_arg_len(arguments, 3);
+				runtime::table* table = table_arg(arguments[0], true);
+				table->insert(share_arg(arguments[1], gc), share_arg(arguments[2], gc));
+				return gc->new_apartment(new value(VALUE_TYPE_NULL, nullptr));
+			}
+
+			runtime::reference_apartment* map_get(const std::vector<value*>& arguments, runtime::garbage_collector* gc) {
+				match_arg_len(arguments, 2);
+				runtime::table* table = table_arg(arguments[0], true);
+				long entry = table->find(arguments[1]);
+				if (entry < 0)
+					return gc->new_apartment(new value(VALUE_TYPE_NULL, nullptr));
+				runtime::reference_apartment* value = table->get_value(entry);
+				if (value->value->is_primitive())
+					return gc->new_apartment(value->value->clone());
+				return value;
+			}
+
+			runtime::reference_apartment* map_has(const std::vector<value*>& arguments, runtime::garbage_collector* gc) {
+				match_arg_len(arguments, 2);
+				runtime::table* table = table_arg(arguments[0], true);
+				return gc->new_apartment(new value((long double)(table->find(arguments[1]) >= 0)));
+			}
+
+			runtime::reference_apartment* map_values(const std::vector<value*>& arguments, runtime::garbage_collector* gc) {
+				match_arg_len(arguments, 1);
+				runtime::table* table = table_arg(arguments[0], true);
+				runtime::collection* values = new runtime::collection(table->size, gc);
+				for (unsigned int i = 0; i < table->size; i++)
+					set_element(values, i, table->get_value(i));
+				return values->get_parent_ref();
+			}
+
+			runtime::reference_apartment* new_set(const std::vector<value*>& arguments, runtime::garbage_collector* gc) {
+				match_arg_len(arguments, 0);
+				return (new runtime::table(false, gc))->get_parent_ref();
+			}
+
+			runtime::reference_apartment* set_insert(const std::vector<value*>& arguments, runtime::garbage_collector* gc) {
+				match_arg_len(arguments, 2);
+				runtime::table* table = table_arg(arguments[0], false);
+				if (table->find(arguments[1]) >= 0)
+					return gc->new_apartment(new value((long double)0));
+				table->insert(share_arg(arguments[1], gc), nullptr);
+				return gc->new_apartment(new value((long double)1));
+			}
+
+			runtime::reference_apartment* set_find(const std::vector<value*>& arguments, runtime::garbage_collector* gc) {
+				match_arg_len(arguments, 2);
+				runtime::table* table = table_arg(arguments[0], false);
+				return gc->new_apartment(new value((long double)(table->find(arguments[1]) >= 0)));
+			}
+
+			runtime::reference_apartment* keys(const std::vector<value*>& arguments, runtime::garbage_collector* gc) {
+				match_arg_len(arguments, 1);
+				match_arg_type(arguments[0], VALUE_TYPE_TABLE);
+				runtime::table* table = (runtime::table*)arguments[0]->ptr;
+				runtime::collection* keys = new runtime::collection(table->size, gc);
+				for (unsigned int i = 0; i < table->size; i++)
+					set_element(keys, i, table->get_key(i));
+				return keys->get_parent_ref();
+			}
+
+			runtime::reference_apartment* remove(const std::vector<value*>& arguments, runtime::garbage_collector* gc) {
+				match_arg_len(arguments, 2);
+				match_arg_type(arguments[0], VALUE_TYPE_TABLE);
+				runtime::table* table = (runtime::table*)arguments[0]->ptr;
+				return gc->new_apartment(new value((long double)table->remove(arguments[1])));
+			}
+
+			runtime::reference_apartment* size(const std::vector<value*>& arguments, runtime::garbage_collector* gc) {
+				match_arg_len(arguments, 1);
+				match_arg_type(arguments[0], VALUE_TYPE_TABLE);
+				return gc->new_apartment(new value((long double)((runtime::table*)arguments[0]->ptr)->size));
+			}
+		}
+	}
+}
\ No newline at end of file
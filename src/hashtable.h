@@ -0,0 +1,33 @@
+#pragma once
+
+#ifndef HASHTABLE_H
+#define HASHTABLE_H
+
+#include <vector>
+#include "garbage.h"
+#include "references.h"
+#include "value.h"
+
+namespace fastcode {
+	namespace builtins {
+		//native maps and sets, both backed by runtime::table
+		namespace hashtable {
+			runtime::reference_apartment* new_map(const std::vector<value*>& arguments, runtime::garbage_collector* gc);
+			runtime::reference_apartment* map_set(const std::vector<value*>& arguments, runtime::garbage_collector* gc);
+			runtime::reference_apartment* map_get(const std::vector<value*>& arguments, runtime::garbage_collector* gc);
+			runtime::reference_apartment* map_has(const std::vector<value*>& arguments, runtime::garbage_collector* gc);
+			runtime::reference_apartment* map_values(const std::vector<value*>& arguments, runtime::garbage_collector* gc);
+
+			runtime::reference_apartment* new_set(const std::vector<value*>& arguments, runtime::garbage_collector* gc);
+			runtime::reference_apartment* set_insert(const std::vector<value*>& arguments, runtime::garbage_collector* gc);
+			runtime::reference_apartment* set_find(const std::vector<value*>& arguments, runtime::garbage_collector* gc);
+
+			//shared by maps and sets
+			runtime::reference_apartment* keys(const std::vector<value*>& arguments, runtime::garbage_collector* gc);
+			runtime::reference_apartment* remove(const std::vector<value*>& arguments, runtime::garbage_collector* gc);
+			runtime::reference_apartment* size(const std::vector<value*>& arguments, runtime::garbage_collector* gc);
+		}
+	}
+}
+
+#endif // !HASHTABLE_H
\ No newline at end of file
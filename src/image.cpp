@@ -0,0 +1,211 @@
+#include "errors.h"
+#include "collection.h"
+#include "structure.h"
+#include "table.h"
+#include "image.h"
+
+namespace fastcode {
+	namespace runtime {
+		unsigned int heap_writer::index_of(reference_apartment* apartment) {
+			auto it = this->indices.find(apartment);
+			if (it != this->indices.end())
+				return it->second;
+			unsigned int index = (unsigned int)this->apartments.size();
+			this->indices[apartment] = index;
+			this->apartments.push_back(apartment);
+			return index;
+		}
+
+		//nodes are written breadth first, the apartments vector grows as their children are discovered
+		void heap_writer::write_nodes() {
+			for (unsigned int i = 0; i < this->apartments.size(); i++) {
+				value* val = this->apartments[i]->value;
+				switch (val->type)
+				{
+				case VALUE_TYPE_NULL:
+				case VALUE_TYPE_CHAR:
+				case VALUE_TYPE_NUMERICAL:
+					this->writer->write_value(val);
+					break;
+				case VALUE_TYPE_COLLECTION: {
+					collection* col = (collection*)val->ptr;
+					this->writer->write_u8(VALUE_TYPE_COLLECTION);
+					const char* string = col->get_string();
+					if (string != nullptr) {
+						this->writer->write_u8(IMAGE_COLLECTION_STRING);
+						this->writer->write_string(string, col->size);
+					}
+					else if (col->is_packed()) {
+						this->writer->write_u8(IMAGE_COLLECTION_PACKED);
+						this->writer->write_u32((unsigned int)col->size);
+						for (unsigned long j = 0; j < col->size; j++) {
+							value element = col->get_packed(j);
+							this->writer->write_value(&element);
+						}
+					}
+					else {
+						this->writer->write_u8(IMAGE_COLLECTION_BOXED);
+						this->writer->write_u32((unsigned int)col->size);
+						for (unsigned long j = 0; j < col->size; j++)
+							this->writer->write_u32(index_of(col->get_reference(j)));
+					}
+					break;
+				}
+				case VALUE_TYPE_STRUCT: {
+					structure* structure = (class structure*)val->ptr;
+					this->writer->write_u8(VALUE_TYPE_STRUCT);
+					this->writer->write_symbol(structure->get_identifier()->symbol_id);
+					this->writer->write_u32(structure->get_size());
+					for (unsigned int j = 0; j < structure->get_size(); j++)
+						this->writer->write_u32(index_of(structure->get_children()[j]));
+					break;
+				}
+				case VALUE_TYPE_TABLE: {
+					table* table = (class table*)val->ptr;
+					this->writer->write_u8(VALUE_TYPE_TABLE);
+					this->writer->write_u8(table->is_map());
+					this->writer->write_u32(table->size);
+					for (unsigned int j = 0; j < table->size; j++) {
+						this->writer->write_u32(index_of(table->get_key(j)));
+						if (table->is_map())
+							this->writer->write_u32(index_of(table->get_value(j)));
+					}
+					break;
+				}
+				default:
+					throw ERROR_INVALID_VALUE_TYPE;
+				}
+			}
+			this->writer->write_u8(IMAGE_END_NODES);
+		}
+
+		void heap_reader::read_nodes() {
+			unsigned char type;
+			while ((type = this->reader->read_u8()) != IMAGE_END_NODES) {
+				this->nodes.emplace_back(type);
+				node& node = this->nodes.back();
+				switch (type)
+				{
+				case VALUE_TYPE_NULL:
+				case VALUE_TYPE_CHAR:
+				case VALUE_TYPE_NUMERICAL: {
+					value* primitive = this->reader->read_value(type);
+					node.primitive = std::move(*primitive);
+					delete primitive;
+					break;
+				}
+				case VALUE_TYPE_COLLECTION: {
+					node.storage = this->reader->read_u8();
+					if (node.storage == IMAGE_COLLECTION_STRING) {
+						unsigned int length = this->reader->read_u32();
+						node.string.assign(this->reader->read_bytes(length), length);
+					}
+					else if (node.storage == IMAGE_COLLECTION_PACKED) {
+						unsigned int size = this->reader->read_u32();
+						for (unsigned int i = 0; i < size; i++) {
+							value* element = this->reader->read_value();
+							if (element == nullptr)
+								throw ERROR_INVALID_VALUE_TYPE;
+							node.packed.push_back(std::move(*element));
+							delete element;
+						}
+					}
+					else if (node.storage == IMAGE_COLLECTION_BOXED) {
+						unsigned int size = this->reader->read_u32();
+						for (unsigned int i = 0; i < size; i++)
+							node.children.push_back(this->reader->read_u32());
+					}
+					else
+						throw ERROR_INVALID_VALUE_TYPE;
+					break;
+				}
+				case VALUE_TYPE_STRUCT: {
+					node.symbol_id = this->reader->read_symbol();
+					unsigned int size = this->reader->read_u32();
+					for (unsigned int i = 0; i < size; i++)
+						node.children.push_back(this->reader->read_u32());
+					break;
+				}
+				case VALUE_TYPE_TABLE: {
+					node.map = this->reader->read_u8();
+					unsigned int size = this->reader->read_u32() * (node.map ? 2 : 1);
+					for (unsigned int i = 0; i < size; i++)
+						node.children.push_back(this->reader->read_u32());
+					break;
+				}
+				default:
+					throw ERROR_INVALID_VALUE_TYPE;
+				}
+			}
+
+			for (auto it = this->nodes.begin(); it != this->nodes.end(); ++it)
+				for (auto child = it->children.begin(); child != it->children.end(); ++child)
+					if (*child >= this->nodes.size())
+						throw ERROR_INDEX_OUT_OF_RANGE;
+		}
+
+		void heap_reader::build(const std::vector<parsing::structure_prototype*>& struct_definitions, garbage_collector* gc) {
+			for (auto it = this->nodes.begin(); it != this->nodes.end(); ++it) {
+				if (it->type != VALUE_TYPE_STRUCT)
+					continue;
+				if (it->symbol_id >= struct_definitions.size() || struct_definitions[it->symbol_id] == nullptr)
+					throw ERROR_STRUCT_PROTO_NOT_DEFINED;
+				if (struct_definitions[it->symbol_id]->property_count != it->children.size())
+					throw ERROR_PROPERTY_NOT_FOUND;
+			}
+
+			//every apartment is created before any are linked, since nodes can reference later nodes
+			this->apartments.reserve(this->nodes.size());
+			for (auto it = this->nodes.begin(); it != this->nodes.end(); ++it) {
+				switch (it->type)
+				{
+				case VALUE_TYPE_COLLECTION:
+					if (it->storage == IMAGE_COLLECTION_STRING)
+						this->apartments.push_back((new collection(it->string.data(), (unsigned long)it->string.size(), gc))->get_parent_ref());
+					else {
+						unsigned long size = (unsigned long)(it->storage == IMAGE_COLLECTION_PACKED ? it->packed.size() : it->children.size());
+						collection* col = new collection(size, gc);
+						for (unsigned long i = 0; i < it->packed.size(); i++)
+							col->set_primitive(i, &it->packed[i]);
+						this->apartments.push_back(col->get_parent_ref());
+					}
+					break;
+				case VALUE_TYPE_STRUCT:
+					this->apartments.push_back((new structure(struct_definitions[it->symbol_id], gc))->get_parent_ref());
+					break;
+				case VALUE_TYPE_TABLE:
+					this->apartments.push_back((new table(it->map, gc))->get_parent_ref());
+					break;
+				default:
+					this->apartments.push_back(gc->new_apartment(new value(std::move(it->primitive))));
+					break;
+				}
+			}
+
+			for (unsigned int i = 0; i < this->nodes.size(); i++) {
+				node& node = this->nodes[i];
+				if (node.type == VALUE_TYPE_COLLECTION) {
+					collection* col = (collection*)this->apartments[i]->value->ptr;
+					for (unsigned long j = 0; j < node.children.size(); j++)
+						col->set_reference(j, this->apartments[node.children[j]]);
+				}
+				else if (node.type == VALUE_TYPE_STRUCT) {
+					structure* structure = (class structure*)this->apartments[i]->value->ptr;
+					for (unsigned int j = 0; j < node.children.size(); j++)
+						structure->set_reference_at(j, this->apartments[node.children[j]]);
+				}
+			}
+
+			//keys are hashed structurally, so tables are filled once everything else is linked
+			for (unsigned int i = 0; i < this->nodes.size(); i++) {
+				node& node = this->nodes[i];
+				if (node.type != VALUE_TYPE_TABLE)
+					continue;
+				table* table = (class table*)this->apartments[i]->value->ptr;
+				unsigned int stride = node.map ? 2 : 1;
+				for (unsigned int j = 0; j < node.children.size(); j += stride)
+					table->insert(this->apartments[node.children[j]], node.map ? this->apartments[node.children[j + 1]] : nullptr);
+			}
+		}
+	}
+}
\ No newline at end of file
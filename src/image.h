@@ -0,0 +1,107 @@
+#pragma once
+
+#ifndef IMAGE_H
+#define IMAGE_H
+
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include "value.h"
+#include "references.h"
+#include "garbage.h"
+#include "structure.h"
+#include "module.h"
+
+//bumped whenever the image format changes
+#define IMAGE_FORMAT_VERSION 1
+
+//ends a heap's nodes
+#define IMAGE_END_NODES 0xFF
+
+//how a collection node's elements are stored
+#define IMAGE_COLLECTION_STRING 0
+#define IMAGE_COLLECTION_PACKED 1
+#define IMAGE_COLLECTION_BOXED 2
+
+namespace fastcode {
+	namespace runtime {
+		//an image holds an interpreter's procedures, structs, constants and module level variables, so new interpreters can boot from it rather than including and running the same files again
+		//variables are written as a graph of apartment nodes so shared and cyclic references survive the round trip, views are written as copies of the elements they see
+
+		//writes every apartment reachable from a set of roots
+		class heap_writer {
+		private:
+			parsing::module_writer* writer;
+			std::unordered_map<reference_apartment*, unsigned int> indices;
+			std::vector<reference_apartment*> apartments;
+
+			//gets an apartment's node index, queuing it to be written if it hasn't been seen yet
+			unsigned int index_of(reference_apartment* apartment);
+
+		public:
+			heap_writer(parsing::module_writer* writer) {
+				this->writer = writer;
+			}
+
+			//writes a root's node index
+			inline void write_root(reference_apartment* apartment) {
+				this->writer->write_u32(index_of(apartment));
+			}
+
+			//writes every node reachable from the roots, throws an error if a node holds a handle
+			void write_nodes();
+		};
+
+		//reads the nodes a heap writer wrote, and rebuilds their apartments
+		class heap_reader {
+		private:
+			struct node {
+				unsigned char type;
+				value primitive;
+
+				unsigned char storage;
+				std::string string;
+				std::vector<value> packed;
+
+				//the symbol of a struct's prototype, or whether a table's a map
+				unsigned int symbol_id;
+				bool map;
+
+				//the node indices of a boxed collection's elements, a struct's properties or a table's entries
+				std::vector<unsigned int> children;
+
+				node(unsigned char type) : type(type), primitive(VALUE_TYPE_NULL, nullptr), storage(0), symbol_id(0), map(false) {}
+			};
+
+			parsing::module_reader* reader;
+			std::vector<node> nodes;
+			std::vector<reference_apartment*> apartments;
+
+		public:
+			heap_reader(parsing::module_reader* reader) {
+				this->reader = reader;
+			}
+
+			//reads every node, checking that they only reference each other
+			void read_nodes();
+
+			//creates every node's apartment and links them together; throws an error before allocating anything if a struct's prototype doesn't match
+			void build(const std::vector<parsing::structure_prototype*>& struct_definitions, garbage_collector* gc);
+
+			//gets a root's apartment once the heap's built
+			inline reference_apartment* get_root(unsigned int index) {
+				if (index >= this->apartments.size())
+					throw ERROR_INDEX_OUT_OF_RANGE;
+				return this->apartments[index];
+			}
+
+			//checks a root's node index before the heap's built
+			inline void check_root(unsigned int index) {
+				if (index >= this->nodes.size())
+					throw ERROR_INDEX_OUT_OF_RANGE;
+			}
+		};
+	}
+}
+
+#endif // !IMAGE_H
\ No newline at end of file
@@ -0,0 +1,56 @@
+#include "interner.h"
+
+namespace fastcode {
+	namespace parsing {
+		symbol_interner::symbol_interner() {
+			this->slots.resize(INTERNER_MIN_CAPACITY, 0);
+		}
+
+		symbol_interner::~symbol_interner() {
+			for (auto it = this->symbols.begin(); it != this->symbols.end(); ++it)
+				delete[] it->name;
+		}
+
+		void symbol_interner::rehash(unsigned int new_capacity) {
+			this->slots.assign(new_capacity, 0);
+			for (unsigned int id = 0; id < this->symbols.size(); id++) {
+				unsigned int slot = this->symbols[id].hash & (new_capacity - 1);
+				while (this->slots[slot] != 0)
+					slot = (slot + 1) & (new_capacity - 1);
+				this->slots[slot] = id + 1;
+			}
+		}
+
+		unsigned int symbol_interner::intern(const char* name, unsigned long length, unsigned long hash) {
+			unsigned int mask = (unsigned int)this->slots.size() - 1;
+			unsigned int slot = hash & mask;
+			while (this->slots[slot] != 0) {
+				symbol& existing = this->symbols[this->slots[slot] - 1];
+				if (existing.hash == hash && existing.length == length && std::memcmp(existing.name, name, length) == 0)
+					return this->slots[slot] - 1;
+				slot = (slot + 1) & mask;
+			}
+
+			symbol interned;
+			interned.name = new char[length + 1];
+			std::memcpy(interned.name, name, length);
+			interned.name[length] = 0;
+			interned.length = length;
+			interned.hash = hash;
+			unsigned int id = (unsigned int)this->symbols.size();
+			this->symbols.push_back(interned);
+			this->slots[slot] = id + 1;
+
+			//keep the slots at most half full
+			if (this->symbols.size() * 2 > this->slots.size())
+				rehash((unsigned int)this->slots.size() * 2);
+			return id;
+		}
+
+		symbol_interner& get_symbols() {
+			//constructed on first use, so built ins can intern their names while being statically initialized
+			static symbol_interner symbols;
+			return symbols;
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,60 @@
+#pragma once
+
+#ifndef INTERNER_H
+#define INTERNER_H
+
+#include <vector>
+#include <cstring>
+#include "hash.h"
+
+#define INTERNER_MIN_CAPACITY 256
+
+namespace fastcode {
+	namespace parsing {
+		//maps every distinct identifier to a dense symbol id, in the order they're first seen
+		//names are compared in full, so identifiers that happen to share a hash still get different ids
+		class symbol_interner {
+		private:
+			struct symbol {
+				char* name;
+				unsigned long length;
+				unsigned long hash;
+			};
+
+			std::vector<symbol> symbols;
+
+			//open addressed slots, holding a symbol's id plus one, or zero if they're empty
+			std::vector<unsigned int> slots;
+
+			void rehash(unsigned int new_capacity);
+
+		public:
+			symbol_interner();
+			~symbol_interner();
+
+			symbol_interner(const symbol_interner&) = delete;
+
+			//gets the id of a name that's already been hashed with insecure_hash, interning it if it's new; the name doesn't have to be null terminated
+			unsigned int intern(const char* name, unsigned long length, unsigned long hash);
+
+			inline unsigned int intern(const char* name) {
+				unsigned long length = (unsigned long)std::strlen(name);
+				return intern(name, length, insecure_hash(name, length));
+			}
+
+			//gets a symbol's null terminated name, which lives as long as the interner
+			inline const char* get_name(unsigned int id) {
+				return this->symbols[id].name;
+			}
+
+			inline unsigned int size() {
+				return (unsigned int)this->symbols.size();
+			}
+		};
+
+		//the interner shared by every lexer, prototype and built in, so they all agree on symbol ids
+		symbol_interner& get_symbols();
+	}
+}
+
+#endif // !INTERNER_H
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include "errors.h"
 #include "structure.h"
 #include "collection.h"
+#include "table.h"
 #include "tokens.h"
 #include "operators.h"
 #include "builtins.h"
@@ -96,7 +97,7 @@ namespace fastcode {
 			}
 		}
 
-		void print_token_body(std::list<token*> tokens, int indent) {
+		void print_token_body(const std::vector<token*>& tokens, int indent) {
 			std::cout << " {" << std::endl;
 			for (auto i = tokens.begin(); i != tokens.end(); ++i) {
 				print_top_lvl_tok(*i, indent + 1);
@@ -111,7 +112,7 @@ namespace fastcode {
 		}
 
 		void identifier_token::print() {
-			std::cout << this->id_str_ptr;
+			std::cout << get_identifier();
 		}
 
 		void variable_access_token::print() {
@@ -197,6 +198,10 @@ namespace fastcode {
 		}
 
 		void create_array_token::print() {
+			if (this->string != nullptr) {
+				std::cout << '\"' << this->string << '\"';
+				return;
+			}
 			std::cout << '[';
 			for (auto i = this->values.begin(); i != this->values.end(); ++i) {
 				if (i != this->values.begin())
@@ -315,10 +320,10 @@ namespace fastcode {
 		}
 	}
 
-	void handle_syntax_err(int syntax_error, unsigned int pos, const char* source) {
+	void handle_syntax_err(int syntax_error, unsigned int pos, const char* source, unsigned long source_length) {
 		std::cout << std::endl << "***Syntax Error: " << get_err_info(syntax_error) << "***" << std::endl;
 		std::cout << "Error Code: " << syntax_error << '\t' << "Lexer Index: " << pos << std::endl;
-		for (unsigned int i = pos >= 20 ? pos - 20 : 0; i < strlen(source) && i < pos + 20; i++) 
+		for (unsigned int i = pos >= 20 ? pos - 20 : 0; i < source_length && i < pos + 20; i++) 
 			std::cout << source[i];
 		std::cout << "" << std::endl;
 	}
@@ -347,7 +352,7 @@ namespace fastcode {
 		//print_indent(indent);
 		std::cout << '<' << structure->get_identifier()->get_identifier() << '>';
 		runtime::reference_apartment** children = structure->get_children();
-		std::list<parsing::identifier_token*> props = structure->get_proto()->get_properties();
+		const std::vector<parsing::identifier_token*>& props = structure->get_proto()->get_properties();
 		auto it = props.begin();
 		for (unsigned int i = 0; i < structure->get_size(); i++)
 		{
@@ -361,6 +366,14 @@ namespace fastcode {
 	}
 
 	void print_array(runtime::collection* collection, bool primitive_mode) {
+		if (collection->get_string() != nullptr) {
+			if (primitive_mode)
+				std::cout << '\"';
+			std::cout.write(collection->get_string(), collection->size);
+			if (primitive_mode)
+				std::cout << '\"';
+			return;
+		}
 		bool is_str = true;
 		for (unsigned int i = 0; i < collection->size; i++)
 		{
@@ -395,6 +408,25 @@ namespace fastcode {
 		}
 	}
 
+	void print_table(runtime::table* table) {
+		if (table->size > 25) {
+			std::cout << (table->is_map() ? "<map>" : "<set>");
+			return;
+		}
+		std::cout << '{';
+		for (unsigned int i = 0; i < table->size; i++)
+		{
+			print_value(table->get_key(i)->value, false);
+			if (table->is_map()) {
+				std::cout << ": ";
+				print_value(table->get_value(i)->value, false);
+			}
+			if (i != table->size - 1)
+				std::cout << ", ";
+		}
+		std::cout << '}';
+	}
+
 	void print_value(value* val, bool primitive_mode) {
 		switch (val->type)
 		{
@@ -422,43 +454,45 @@ namespace fastcode {
 		case VALUE_TYPE_HANDLE:
 			std::cout << "<handle " << val->ptr << ">";
 			break;
+		case VALUE_TYPE_TABLE:
+			print_table((runtime::table*)val->ptr);
+			break;
 		default:
 			throw ERROR_INVALID_VALUE_TYPE;
 		}
 	}
 
 	namespace builtins {
-		runtime::reference_apartment* print(const std::vector<value*> arguments, runtime::garbage_collector* gc) {
+		runtime::reference_apartment* print(const std::vector<value*>& arguments, runtime::garbage_collector* gc) {
 			for (auto it = arguments.begin(); it != arguments.end(); ++it) {
 				print_value(*it, true);
 			}
 			return gc->new_apartment(new value(VALUE_TYPE_NULL, nullptr));
 		}
 
-		runtime::reference_apartment* print_line(const std::vector<value*> arguments, runtime::garbage_collector* gc) {
+		runtime::reference_apartment* print_line(const std::vector<value*>& arguments, runtime::garbage_collector* gc) {
 			runtime::reference_apartment* appt = print(arguments, gc);
 			std::cout << std::endl;
 			return appt;
 		}
 
-		runtime::reference_apartment* get_input(const std::vector<value*> arguments, runtime::garbage_collector* gc) {
+		runtime::reference_apartment* get_input(const std::vector<value*>& arguments, runtime::garbage_collector* gc) {
 			char* input = new char[250];
 			std::cin.getline(input, 250);
 			runtime::collection* str = from_c_str(input, gc);
 			return str->get_parent_ref();
 		}
 
-		runtime::reference_apartment* file_read_text(const std::vector<value*> arguments, runtime::garbage_collector* gc) {
+		runtime::reference_apartment* file_read_text(const std::vector<value*>& arguments, runtime::garbage_collector* gc) {
 			match_arg_len(arguments, 1);
 			match_arg_type(arguments[0], VALUE_TYPE_COLLECTION);
 
-			char* file_path = to_c_str(arguments[0]);
+			string_arg file_path(arguments[0]);
 
-			std::ifstream infile(file_path, std::ifstream::binary);
+			std::ifstream infile(file_path.c_str(), std::ifstream::binary);
 
 			if (!infile.is_open())
-				return gc->new_apartment(new value(VALUE_TYPE_NUMERICAL, new long double(0)));
-			delete[] file_path;
+				return gc->new_apartment(new value((long double)0));
 
 			infile.seekg(0, std::ios::end);
 			unsigned long buffer_length = infile.tellg();
@@ -468,39 +502,36 @@ namespace fastcode {
 			infile.close();
 			buffer[buffer_length] = 0;
 
-			runtime::collection* strcol = from_c_str(buffer, gc);
+			runtime::collection* strcol = new runtime::collection(buffer, buffer_length, gc);
 			delete[] buffer;
 			return strcol->get_parent_ref();
 		}
 
-		runtime::reference_apartment* file_write_text(const std::vector<value*> arguments, runtime::garbage_collector* gc) {
+		runtime::reference_apartment* file_write_text(const std::vector<value*>& arguments, runtime::garbage_collector* gc) {
 			match_arg_len(arguments, 2);
 			match_arg_type(arguments[0], VALUE_TYPE_COLLECTION);
 			match_arg_type(arguments[1], VALUE_TYPE_COLLECTION);
 
-			char* file_path = to_c_str(arguments[0]);
+			string_arg file_path(arguments[0]);
 
-			std::ofstream infile(file_path, std::ofstream::binary);
+			std::ofstream infile(file_path.c_str(), std::ofstream::binary);
 
 			if (!infile.is_open())
-				return gc->new_apartment(new value(VALUE_TYPE_NUMERICAL, new long double(0)));
-			delete[] file_path;
+				return gc->new_apartment(new value((long double)0));
 
-			char* buffer = to_c_str(arguments[1]);
-			infile.write(buffer, strlen(buffer));
+			string_arg buffer(arguments[1]);
+			infile.write(buffer.c_str(), buffer.size());
 			infile.close();
-			delete[] buffer;
 
-			return gc->new_apartment(new value(VALUE_TYPE_NUMERICAL, new long double(1)));
+			return gc->new_apartment(new value((long double)1));
 		}
 
-		runtime::reference_apartment* system_call(const std::vector<value*> arguments, runtime::garbage_collector* gc) {
+		runtime::reference_apartment* system_call(const std::vector<value*>& arguments, runtime::garbage_collector* gc) {
 			match_arg_len(arguments, 1);
 			match_arg_type(arguments[0], VALUE_TYPE_COLLECTION);
 
-			char* command = to_c_str(arguments[0]);
-			system(command);
-			delete[] command;
+			string_arg command(arguments[0]);
+			system(command.c_str());
 
 			return gc->new_apartment(new value(VALUE_TYPE_NULL, nullptr));
 		}
@@ -1,4 +1,6 @@
 #include <ctype.h>
+#include <cstring>
+#include <string>
 #include "errors.h"
 #include "hash.h"
 #include "operators.h"
@@ -41,11 +43,12 @@ namespace fastcode {
 		inline function_call_token* print_encapsulate(token* token) {
 			if (token->type == TOKEN_FUNCTION_CALL) {
 				function_call_token* call_tok = (function_call_token*)token;
-				if (call_tok->identifier->id_hash == 275790354) {
+				static const unsigned int print_symbol = get_symbols().intern("print");
+				if (call_tok->identifier->symbol_id == print_symbol) {
 					return call_tok;
 				}
 			}
-			std::list<class token*> args;
+			std::vector<class token*> args;
 			args.push_back(token);
 			return new function_call_token(new identifier_token("print"), args);
 		}
@@ -76,123 +79,100 @@ namespace fastcode {
 				read_char();
 			}
 			if (isalpha(last_char) || last_char == '_' || last_char == '@') {
-				std::list<char> id_chars;
+				//identifiers are hashed while they're scanned, and only interned if they aren't keywords
+				const char* id_start = source + position - 1;
+				unsigned long id_length = 0;
+				insecure_hasher hasher;
 				do {
-					id_chars.push_back(last_char);
+					hasher.push(last_char);
+					id_length++;
 				} while (isalnum(read_char()) || last_char == '_' || last_char == '@');
-				char* id_buf = new char[id_chars.size() + 1];
-				int index = 0;
-				for (auto it = id_chars.begin(); it != id_chars.end(); ++it)
-					id_buf[index++] = *it;
-				id_buf[index] = 0; //remeber to add a nul terminator
-				unsigned long hash = insecure_hash(id_buf);
+				unsigned long hash = hasher.hash();
 				//switches use pre-computed hashes because only constants are allowed
 				switch (hash)
 				{
 				case 257929342: //while
-					delete[] id_buf;
 					return last_tok = new token(TOKEN_WHILE);
 				case 5863380: //if
-					delete[] id_buf;
 					return last_tok = new token(TOKEN_IF);
 				case 2090257189: //elif
-					delete[] id_buf;
 					return last_tok = new token(TOKEN_ELIF);
 				case 2090232142: //else
-					delete[] id_buf;
 					return last_tok = new token(TOKEN_ELSE);
 				case 193510031: // new
-					delete[] id_buf;
 					return last_tok = new token(TOKEN_CREATE_STRUCT);
 				case 498533450: //struct
 				case 4184890820: //record
-					delete[] id_buf;
 					return last_tok = new token(TOKEN_STRUCT_PROTO);
 				case 998468366: //proc
 				case 2090156121: //procedure
 				case 1574308811: //function
-					delete[] id_buf;
 					return last_tok = new token(TOKEN_FUNC_PROTO);
 				case 193491522: //ref
-					delete[] id_buf;
 					return last_tok = new token(TOKEN_GET_REFERENCE);
 				case 281511589: //return
-					delete[] id_buf;
 					return last_tok = new token(TOKEN_RETURN);
 				case 193489624: //and
-					delete[] id_buf;
 					return last_tok = new token(OP_AND);
 				case 5863782: //or
-					delete[] id_buf;
 					return last_tok = new token(OP_OR);
 				case 4135260141:
-					delete[] id_buf;
 					return last_tok = new token(TOKEN_STATIC);
 				case 275975372:
-					delete[] id_buf;
 					return last_tok = new token(TOKEN_CONST);
 				case 1413452809:
-					delete[] id_buf;
 					return last_tok = new token(TOKEN_INCLUDE);
 				case 264645514: //break
-					delete[] id_buf;
 					return last_tok = new token(TOKEN_BREAK);
 				case 271304754:
-					delete[] id_buf;
 					return last_tok = new token(TOKEN_GROUP);
 				case 303295209:
-					delete[] id_buf;
 					return last_tok = new token(TOKEN_END_GROUP);
 				case 193504908:
-					delete[] id_buf;
 					return last_tok = new token(TOKEN_FOR);
 				case 5863644:
-					delete[] id_buf;
 					return last_tok = new token(TOKEN_IN);
 				case 470537897:
-					delete[] id_buf;
 					return last_tok = new token(TOKEN_PARAMS);
 				case 193499145:
-					delete[] id_buf;
-					while (last_char != '\n')
+					while (last_char != '\n' && last_char != 0)
 						read_char();
 					return read_token();
 				default: {
-					return last_tok = new identifier_token(id_buf, hash);
+					return last_tok = new identifier_token(get_symbols().intern(id_start, id_length, hash));
 				}
 				}
 			}
 			else if (isdigit(last_char)) {
-				std::list<char> num_chars;
+				const char* num_start = source + position - 1;
+				unsigned long num_length = 0;
 				do {
-					num_chars.push_back(last_char);
+					num_length++;
 				} while (isdigit(read_char()) || last_char == '.');
-				char* num_buf = new char[num_chars.size() + 1];
-				int index = 0;
-				for (auto it = num_chars.begin(); it != num_chars.end(); ++it)
-					num_buf[index++] = *it;
-				num_buf[index] = 0;
-				value_token* to_ret = new value_token(new value(VALUE_TYPE_NUMERICAL, new long double(std::strtold(num_buf, NULL))));
-				delete[] num_buf;
-				return last_tok = to_ret;
+				//the source isn't null terminated, so the digits are copied before they're parsed
+				std::string num_str(num_start, num_length);
+				return last_tok = new value_token(new value(std::strtold(num_str.c_str(), NULL)));
 			}
 			else if (last_char == '\"') {
-				std::list<token*> chars;
+				std::string chars;
 				read_char();
 				while (last_char != 0 && last_char != '\"')
 				{
-					chars.push_back(new value_token(new value(VALUE_TYPE_CHAR, new char(read_data_char()))));
+					chars.push_back(read_data_char());
 				}
 				if (last_char == 0)
 					throw ERROR_UNEXPECTED_END;
 				read_char();
-				return last_tok = new create_array_token(chars);
+				char* str_buf = new char[chars.size() + 1];
+				std::memcpy(str_buf, chars.data(), chars.size());
+				str_buf[chars.size()] = 0;
+				return last_tok = new create_array_token(str_buf, (unsigned long)chars.size());
 			}
 			else if (last_char == '\'') {
 				read_char();
 				char dat_char = read_data_char();
 				read_char();
-				return last_tok = new value_token(new value(VALUE_TYPE_CHAR, new char(dat_char)));
+				return last_tok = new value_token(new value(dat_char));
 			}
 			char old = last_char;
 			read_char();
@@ -313,8 +293,8 @@ namespace fastcode {
 			return ret_char;
 		}
 
-		std::list<token*> lexer::tokenize(bool interactive_mode) {
-			std::list<token*> tokens;
+		std::vector<token*> lexer::tokenize(bool interactive_mode) {
+			std::vector<token*> tokens;
 			while (last_tok != nullptr && last_tok->type != TOKEN_CLOSE_BRACE)
 			{
 				token* tok = tokenize_statement(interactive_mode);
@@ -354,14 +334,11 @@ namespace fastcode {
 				delete last_tok;
 				match_tok(read_token(), TOKEN_IDENTIFIER);
 				identifier_token* id = (identifier_token*)last_tok;
-				if (lexer_state->constants.count(id->id_hash)) {
-					delete lexer_state->constants[id->id_hash];
-				}
 				match_tok(read_token(), TOKEN_SET);
 				delete last_tok;
 				match_tok(read_token(), TOKEN_VALUE);
 				value_token* value_tok = (value_token*)last_tok;
-				lexer_state->constants[id->id_hash] = value_tok;
+				lexer_state->define_constant(id->symbol_id, value_tok);
 				delete id;
 				read_token();
 				return nullptr;
@@ -375,7 +352,7 @@ namespace fastcode {
 				delete last_tok;
 				read_token();
 				token* val_tok = tokenize_expression();
-				std::list<token*> modifiers;
+				std::vector<token*> modifiers;
 				modifiers.push_back(id);
 				return new set_token(new variable_access_token(modifiers), val_tok, true);
 			}
@@ -388,15 +365,10 @@ namespace fastcode {
 				delete last_tok;
 				match_tok(read_token(), TOKEN_CREATE_ARRAY);
 				create_array_token* create_str = (create_array_token*)last_tok;
-				char* buf = new char[create_str->values.size() + 1];
-				unsigned char size = 0;
-				for (auto it = create_str->values.begin(); it != create_str->values.end(); ++it) {
-					value_token* val_tok = (value_token*)*it;
-					value* val = val_tok->get_value();
-					buf[size++] = *val->get_char();
-					delete val;
-				}
-				buf[size] = 0;
+				if (create_str->string == nullptr)
+					throw ERROR_UNEXPECTED_TOKEN;
+				char* buf = create_str->string;
+				create_str->string = nullptr;
 				delete create_str;
 				read_token();
 				return new include_token(buf);
@@ -473,7 +445,7 @@ namespace fastcode {
 				lexer_state->declare_id(proto_id, GROUP_TYPE_STRUCT);
 				match_tok(read_token(), TOKEN_OPEN_BRACE);
 				delete last_tok;
-				std::list<identifier_token*> properties;
+				std::vector<identifier_token*> properties;
 				while (last_tok != nullptr && read_token()->type != TOKEN_CLOSE_BRACE)
 				{
 					match_tok(last_tok, TOKEN_IDENTIFIER);
@@ -492,7 +464,7 @@ namespace fastcode {
 				lexer_state->declare_id(proto_id, GROUP_TYPE_FUNC);
 				match_tok(read_token(), TOKEN_OPEN_PARAM);
 				delete last_tok;
-				std::list<identifier_token*> params;
+				std::vector<identifier_token*> params;
 				bool params_mode = false;
 				while (last_tok != nullptr && read_token()->type != TOKEN_CLOSE_PARAM)
 				{
@@ -521,13 +493,13 @@ namespace fastcode {
 			throw ERROR_UNEXPECTED_TOKEN;
 		}
 
-		std::list<token*> lexer::tokenize_body() {
+		std::vector<token*> lexer::tokenize_body() {
 			if (last_tok == nullptr)
 				throw ERROR_UNEXPECTED_END;
 			else if (last_tok->type == TOKEN_OPEN_BRACE) {
 				delete last_tok;
 				read_token();
-				std::list<token*> body = tokenize(false);
+				std::vector<token*> body = tokenize(false);
 				delete last_tok;
 				read_token();
 				return body;
@@ -535,7 +507,7 @@ namespace fastcode {
 			else if (last_tok->type == TOKEN_QUICK_BODY) {
 				delete last_tok;
 				read_token();
-				std::list<token*> body;
+				std::vector<token*> body;
 				if (last_tok == nullptr)
 					throw ERROR_UNEXPECTED_END;
 				body.push_back(tokenize_statement(false));
@@ -554,7 +526,7 @@ namespace fastcode {
 		}
 
 		variable_access_token* lexer::tokenize_var_access(identifier_token* identifier) {
-			std::list<token*> toks;
+			std::vector<token*> toks;
 			toks.push_back(identifier);
 			while (last_tok != nullptr)
 			{
@@ -586,7 +558,7 @@ namespace fastcode {
 				//tokenize function call
 				if (last_tok != nullptr && last_tok->type == TOKEN_OPEN_PARAM) {
 					delete last_tok;
-					std::list<token*> arguments;
+					std::vector<token*> arguments;
 					while (last_tok != nullptr)
 					{
 						read_token();
@@ -606,10 +578,10 @@ namespace fastcode {
 				}
 				else
 				{
-					if (lexer_state->constants.count(identifier->id_hash)) {
-						unsigned long hash = identifier->id_hash;
+					value_token* constant = lexer_state->find_constant(identifier->symbol_id);
+					if (constant != nullptr) {
 						delete identifier;
-						return new value_token(lexer_state->constants[hash]->get_value());
+						return new value_token(constant->get_value());
 					}
 
 					if (last_tok != nullptr && last_tok->type == TOKEN_SET)
@@ -659,7 +631,7 @@ namespace fastcode {
 			}
 			else if (last_tok->type == TOKEN_OPEN_BRACKET) {
 				delete last_tok;
-				std::list<token*> values;
+				std::vector<token*> values;
 
 				while (last_tok != nullptr)
 				{
@@ -4,6 +4,7 @@
 #define LEXER_H
 
 #include <list>
+#include <string>
 #include <unordered_set>
 #include <unordered_map>
 
@@ -22,7 +23,7 @@ namespace fastcode {
 			private:
 				struct identifier_system
 				{
-					std::unordered_set<unsigned long> declerations;
+					std::unordered_set<unsigned int> declerations;
 					std::list<identifier_token*> references;
 				};
 
@@ -32,28 +33,17 @@ namespace fastcode {
 					identifier_token* identifier;
 
 					inline void proc_id(identifier_token* id) {
-						std::list<char> chars;
-
-						for (int i = 0; i < strlen(id->get_identifier()); i++)
-							chars.push_back(id->get_identifier()[i]);
+						std::string mangled(id->get_identifier());
 
 						group* current = this;
 						while (current != nullptr)
 						{
-							chars.push_back('@');
-							for (int i = 0; i < strlen(current->identifier->get_identifier()); i++)
-								chars.push_back(current->identifier->get_identifier()[i]);
+							mangled.push_back('@');
+							mangled.append(current->identifier->get_identifier());
 							current = current->parent;
 						}
 
-						char* new_buf = new char[chars.size() + 1];
-						unsigned long in = 0;
-						for (auto i = chars.begin(); i != chars.end(); ++i) {
-							new_buf[in++] = *i;
-						}
-						new_buf[in] = 0;
-
-						id->set_c_str(new_buf);
+						id->symbol_id = get_symbols().intern(mangled.c_str());
 					}
 				public:
 					group* parent;
@@ -64,7 +54,7 @@ namespace fastcode {
 					}
 
 					inline void proc_decleration(identifier_token* id, unsigned char type) {
-						id_systems[type].declerations.insert(id->id_hash);
+						id_systems[type].declerations.insert(id->symbol_id);
 						proc_id(id);
 					}
 
@@ -77,7 +67,7 @@ namespace fastcode {
 						{
 							std::list<std::list<identifier_token*>::iterator> to_remove;
 							for (auto i = id_systems[type].references.begin(); i != id_systems[type].references.end(); ++i) {
-								if (id_systems[type].declerations.count((*i)->id_hash)) {
+								if (id_systems[type].declerations.count((*i)->symbol_id)) {
 									proc_id(*i);
 									if (!remall)
 										to_remove.push_back(i);
@@ -100,7 +90,22 @@ namespace fastcode {
 
 				group* top_group = nullptr;
 			public:
-				std::unordered_map<unsigned long, value_token*> constants;
+				//the constants a file's lexing depended on and defined, so a cached module can be checked against, and replay them
+				struct constant_log {
+					//the value each constant had when it was first looked up, or null if the identifier wasn't a constant
+					std::unordered_map<unsigned int, value*> lookups;
+					std::unordered_set<unsigned int> definitions;
+
+					~constant_log() {
+						for (auto it = this->lookups.begin(); it != this->lookups.end(); ++it)
+							delete (*it).second;
+					}
+				};
+
+				std::unordered_map<unsigned int, value_token*> constants;
+
+				//records constant lookups and definitions while it isn't null
+				constant_log* log = nullptr;
 
 				~lexer_state() {
 					for (auto it = this->constants.begin(); it != this->constants.end(); ++it)
@@ -109,6 +114,25 @@ namespace fastcode {
 						pop_group();
 				}
 
+				//gets a constant, or null if the identifier isn't a constant
+				inline value_token* find_constant(unsigned int symbol_id) {
+					auto it = this->constants.find(symbol_id);
+					value_token* constant = it == this->constants.end() ? nullptr : it->second;
+					if (this->log != nullptr && !this->log->definitions.count(symbol_id) && !this->log->lookups.count(symbol_id))
+						this->log->lookups[symbol_id] = constant == nullptr ? nullptr : constant->get_value();
+					return constant;
+				}
+
+				//defines or redefines a constant, taking ownership of it's value token
+				inline void define_constant(unsigned int symbol_id, value_token* constant) {
+					auto it = this->constants.find(symbol_id);
+					if (it != this->constants.end())
+						delete it->second;
+					this->constants[symbol_id] = constant;
+					if (this->log != nullptr)
+						this->log->definitions.insert(symbol_id);
+				}
+
 				inline void declare_id(identifier_token* id, unsigned char type) {
 					if (top_group != nullptr)
 						top_group->proc_decleration(id, type);
@@ -148,7 +172,7 @@ namespace fastcode {
 				return this->position;
 			}
 
-			std::list<token*> tokenize(bool interactive_mode);
+			std::vector<token*> tokenize(bool interactive_mode);
 		private:
 			const char* source;
 			unsigned long position;
@@ -166,7 +190,7 @@ namespace fastcode {
 			//reads the next top-level token
 			token* read_token();
 			token* tokenize_statement(bool interactive_mode);
-			std::list<token*> tokenize_body();
+			std::vector<token*> tokenize_body();
 			variable_access_token* tokenize_var_access();
 			variable_access_token* tokenize_var_access(identifier_token* identifier);
 			token* tokenize_expression(unsigned char min = 0);
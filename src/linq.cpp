@@ -1,10 +1,12 @@
+#include <cmath>
 #include "builtins.h"
 #include "collection.h"
+#include "table.h"
 #include "linq.h"
 
 namespace fastcode {
 	namespace builtins {
-		runtime::reference_apartment* allocate_array(const std::vector<value*> arguments, runtime::garbage_collector* gc) {
+		runtime::reference_apartment* allocate_array(const std::vector<value*>& arguments, runtime::garbage_collector* gc) {
 			match_arg_len(arguments, 1);
 			match_arg_type(arguments[0], VALUE_TYPE_NUMERICAL);
 
@@ -18,56 +20,147 @@ namespace fastcode {
 			return allocated_array->get_parent_ref();
 		}
 
-		runtime::reference_apartment* get_length(const std::vector<value*> arguments, runtime::garbage_collector* gc) {
+		runtime::reference_apartment* get_length(const std::vector<value*>& arguments, runtime::garbage_collector* gc) {
 			match_arg_len(arguments, 1);
+			if (arguments[0]->type == VALUE_TYPE_TABLE)
+				return gc->new_apartment(new value((long double)((runtime::table*)arguments[0]->ptr)->size));
 			match_arg_type(arguments[0], VALUE_TYPE_COLLECTION);
 
 			runtime::collection* collection = (runtime::collection*)arguments[0]->ptr;
-			return gc->new_apartment(new value(VALUE_TYPE_NUMERICAL, new long double((long double)collection->size)));
+			return gc->new_apartment(new value((long double)collection->size));
 		}
 
-		runtime::reference_apartment* count_instances(const std::vector<value*> arguments, runtime::garbage_collector* gc) {
+		//views can't change size, since they share the viewed collection's storage
+		static runtime::collection* growable_arg(value* value) {
+			match_arg_type(value, VALUE_TYPE_COLLECTION);
+			runtime::collection* collection = (runtime::collection*)value->ptr;
+			if (collection->is_view())
+				throw ERROR_INVALID_VALUE_TYPE;
+			return collection;
+		}
+
+		runtime::reference_apartment* push_element(const std::vector<value*>& arguments, runtime::garbage_collector* gc) {
+			match_arg_len(arguments, 2);
+			match_arg_type(arguments[0], VALUE_TYPE_COLLECTION);
+			runtime::collection* collection = growable_arg(arguments[0]);
+			if (arguments[1]->is_primitive())
+				collection->push(arguments[1]->clone());
+			else
+				collection->push_reference(share_arg(arguments[1], gc));
+			return gc->new_apartment(new value(VALUE_TYPE_NULL, nullptr));
+		}
+
+		runtime::reference_apartment* pop_element(const std::vector<value*>& arguments, runtime::garbage_collector*) {
+			match_arg_len(arguments, 1);
+			runtime::collection* collection = growable_arg(arguments[0]);
+			if (collection->size == 0)
+				throw ERROR_INDEX_OUT_OF_RANGE;
+			return collection->pop();
+		}
+
+		runtime::reference_apartment* insert_element(const std::vector<value*>& arguments, runtime::garbage_collector* gc) {
+			match_arg_len(arguments, 3);
+			runtime::collection* collection = growable_arg(arguments[0]);
+			match_arg_type(arguments[1], VALUE_TYPE_NUMERICAL);
+			long double index = *arguments[1]->get_numerical();
+			if (index < 0 || index > collection->size)
+				throw ERROR_INDEX_OUT_OF_RANGE;
+			if (arguments[2]->is_primitive())
+				collection->push(arguments[2]->clone());
+			else
+				collection->push_reference(share_arg(arguments[2], gc));
+			collection->move_last((unsigned long)index);
+			return gc->new_apartment(new value(VALUE_TYPE_NULL, nullptr));
+		}
+
+		runtime::reference_apartment* remove_element(const std::vector<value*>& arguments, runtime::garbage_collector*) {
+			match_arg_len(arguments, 2);
+			runtime::collection* collection = growable_arg(arguments[0]);
+			match_arg_type(arguments[1], VALUE_TYPE_NUMERICAL);
+			long double index = *arguments[1]->get_numerical();
+			if (index < 0 || index >= collection->size)
+				throw ERROR_INDEX_OUT_OF_RANGE;
+			return collection->remove((unsigned long)index);
+		}
+
+		runtime::reference_apartment* get_slice(const std::vector<value*>& arguments, runtime::garbage_collector*) {
+			if (arguments.size() != 2 && arguments.size() != 3)
+				throw ERROR_UNEXPECTED_ARGUMENT_SIZE;
+			match_arg_type(arguments[0], VALUE_TYPE_COLLECTION);
+			runtime::collection* collection = (runtime::collection*)arguments[0]->ptr;
+			match_arg_type(arguments[1], VALUE_TYPE_NUMERICAL);
+			long double start = *arguments[1]->get_numerical();
+			long double stop = collection->size;
+			if (arguments.size() == 3) {
+				match_arg_type(arguments[2], VALUE_TYPE_NUMERICAL);
+				stop = *arguments[2]->get_numerical();
+			}
+			if (start < 0 || stop < start || stop > collection->size)
+				throw ERROR_INDEX_OUT_OF_RANGE;
+			return (new runtime::collection(collection, (unsigned long)start, (unsigned long)(stop - start)))->get_parent_ref();
+		}
+
+		runtime::reference_apartment* count_instances(const std::vector<value*>& arguments, runtime::garbage_collector* gc) {
 			match_arg_len(arguments, 2);
 			match_arg_type(arguments[0], VALUE_TYPE_COLLECTION);
 
 			runtime::collection* collection = (runtime::collection*)arguments[0]->ptr;
 			unsigned int instances = 0;
 
+			//strings are scanned without widening their bytes
+			const char* str = collection->get_string();
+			if (str != nullptr) {
+				for (unsigned long i = 0; i < collection->size; i++)
+				{
+					value c(str[i]);
+					if (c.compare(arguments[1]) == 0)
+						instances++;
+				}
+				return gc->new_apartment(new value((long double)instances));
+			}
+
 			for (unsigned int i = 0; i < collection->size; i++)
 			{
 				if (collection->get_value(i)->compare(arguments[1]) == 0)
 					instances++;
 			}
-			return gc->new_apartment(new value(VALUE_TYPE_NUMERICAL, new long double((long double)instances)));
+			return gc->new_apartment(new value((long double)instances));
 		}
 
-		runtime::reference_apartment* get_range(const std::vector<value*> arguments, runtime::garbage_collector* gc) {
-			long double start = 0;
-			long double step = 1;
-			long double stop;
+		void get_range_bounds(const std::vector<value*>& arguments, long double* start, long double* stop, long double* step) {
+			*start = 0;
+			*step = 1;
+			if (arguments.size() < 1 || arguments.size() > 3)
+				throw ERROR_UNEXPECTED_ARGUMENT_SIZE;
+			for (auto it = arguments.begin(); it != arguments.end(); ++it)
+				match_arg_type(*it, VALUE_TYPE_NUMERICAL);
 			if (arguments.size() == 1)
-				stop = *arguments[0]->get_numerical();
-			else if (arguments.size() == 2) {
-				start = *arguments[0]->get_numerical();
-				stop = *arguments[1]->get_numerical();
-			}
-			else if (arguments.size() == 3) {
-				start = *arguments[0]->get_numerical();
-				stop = *arguments[1]->get_numerical();
-				step = *arguments[2]->get_numerical();
+				*stop = *arguments[0]->get_numerical();
+			else {
+				*start = *arguments[0]->get_numerical();
+				*stop = *arguments[1]->get_numerical();
+				if (arguments.size() == 3)
+					*step = *arguments[2]->get_numerical();
 			}
-			else
-				throw ERROR_UNEXPECTED_ARGUMENT_SIZE;
-
-			unsigned long size = abs(stop - start) / abs(step);
+			if (*step == 0)
+				throw ERROR_INVALID_VALUE_TYPE;
+		}
 
-			runtime::collection* range = new runtime::collection(size, gc);
+		unsigned long get_range_size(long double start, long double stop, long double step) {
+			long double steps = (stop - start) / step;
+			return steps > 0 ? (unsigned long)ceill(steps) : 0;
+		}
 
-			unsigned int j = 0;
+		runtime::reference_apartment* get_range(const std::vector<value*>& arguments, runtime::garbage_collector* gc) {
+			long double start, stop, step;
+			get_range_bounds(arguments, &start, &stop, &step);
+			unsigned long size = get_range_size(start, stop, step);
 
-			for (long double i = start; step > 0 ? i < stop : i > stop; i += step)
-				range->set_value(j++, new value(VALUE_TYPE_NUMERICAL, new long double(i)));
-			
+			runtime::collection* range = new runtime::collection(size, gc);
+			for (unsigned long i = 0; i < size; i++) {
+				value number(start + i * step);
+				range->set_primitive(i, &number);
+			}
 			return range->get_parent_ref();
 		}
 	}
@@ -10,10 +10,28 @@
 
 namespace fastcode {
 	namespace builtins {
-		runtime::reference_apartment* allocate_array(const std::vector<value*> arguments, runtime::garbage_collector* gc);
-		runtime::reference_apartment* get_length(const std::vector<value*> arguments, runtime::garbage_collector* gc);
-		runtime::reference_apartment* count_instances(const std::vector<value*> arguments, runtime::garbage_collector* gc);
-		runtime::reference_apartment* get_range(const std::vector<value*> arguments, runtime::garbage_collector* gc);
+		runtime::reference_apartment* allocate_array(const std::vector<value*>& arguments, runtime::garbage_collector* gc);
+		runtime::reference_apartment* get_length(const std::vector<value*>& arguments, runtime::garbage_collector* gc);
+
+		//growing and shrinking collections in place
+		runtime::reference_apartment* push_element(const std::vector<value*>& arguments, runtime::garbage_collector* gc);
+		runtime::reference_apartment* pop_element(const std::vector<value*>& arguments, runtime::garbage_collector* gc);
+		runtime::reference_apartment* insert_element(const std::vector<value*>& arguments, runtime::garbage_collector* gc);
+		runtime::reference_apartment* remove_element(const std::vector<value*>& arguments, runtime::garbage_collector* gc);
+
+		//slices a collection without copying it, the slice shares the collection's elements
+		runtime::reference_apartment* get_slice(const std::vector<value*>& arguments, runtime::garbage_collector* gc);
+
+		runtime::reference_apartment* count_instances(const std::vector<value*>& arguments, runtime::garbage_collector* gc);
+
+		//reads the start, stop and step of range's arguments
+		void get_range_bounds(const std::vector<value*>& arguments, long double* start, long double* stop, long double* step);
+
+		//gets the amount of numbers in a range
+		unsigned long get_range_size(long double start, long double stop, long double step);
+
+		//materializes a range as a collection, for loops directly over a call to range stream it instead
+		runtime::reference_apartment* get_range(const std::vector<value*>& arguments, runtime::garbage_collector* gc);
 	}
 }
 
@@ -0,0 +1,86 @@
+#include "mapped_file.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace fastcode {
+	namespace parsing {
+#ifdef _WIN32
+		mapped_file::mapped_file(const char* path) {
+			this->data = "";
+			this->length = 0;
+			this->open = false;
+			this->mapping_handle = NULL;
+			this->file_handle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+			if (this->file_handle == INVALID_HANDLE_VALUE)
+				return;
+			LARGE_INTEGER size;
+			if (!GetFileSizeEx(this->file_handle, &size))
+				return;
+
+			//empty files can't be mapped
+			if (size.QuadPart == 0) {
+				this->open = true;
+				return;
+			}
+			this->mapping_handle = CreateFileMappingA(this->file_handle, NULL, PAGE_READONLY, 0, 0, NULL);
+			if (this->mapping_handle == NULL)
+				return;
+			const char* view = (const char*)MapViewOfFile(this->mapping_handle, FILE_MAP_READ, 0, 0, 0);
+			if (view == NULL)
+				return;
+			this->data = view;
+			this->length = (unsigned long)size.QuadPart;
+			this->open = true;
+		}
+
+		mapped_file::~mapped_file() {
+			if (this->length > 0)
+				UnmapViewOfFile(this->data);
+			if (this->mapping_handle != NULL)
+				CloseHandle(this->mapping_handle);
+			if (this->file_handle != INVALID_HANDLE_VALUE)
+				CloseHandle(this->file_handle);
+		}
+#else
+		mapped_file::mapped_file(const char* path) {
+			this->data = "";
+			this->length = 0;
+			this->open = false;
+			this->file_descriptor = ::open(path, O_RDONLY);
+			if (this->file_descriptor < 0)
+				return;
+			struct stat info;
+			if (fstat(this->file_descriptor, &info) != 0 || !S_ISREG(info.st_mode))
+				return;
+
+			//empty files can't be mapped
+			if (info.st_size == 0) {
+				this->open = true;
+				return;
+			}
+			void* view = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, this->file_descriptor, 0);
+			if (view == MAP_FAILED)
+				return;
+			this->data = (const char*)view;
+			this->length = (unsigned long)info.st_size;
+			this->open = true;
+		}
+
+		mapped_file::~mapped_file() {
+			if (this->length > 0)
+				munmap((void*)this->data, this->length);
+			if (this->file_descriptor >= 0)
+				close(this->file_descriptor);
+		}
+#endif
+	}
+}
\ No newline at end of file
@@ -0,0 +1,44 @@
+#pragma once
+
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+namespace fastcode {
+	namespace parsing {
+		//a read only source file mapped into memory, so it can be lexed in place instead of being copied into a buffer
+		//the mapping isn't null terminated, and it's unmapped once the file is destroyed
+		class mapped_file {
+		private:
+			const char* data;
+			unsigned long length;
+			bool open;
+
+#ifdef _WIN32
+			void* file_handle;
+			void* mapping_handle;
+#else
+			int file_descriptor;
+#endif
+
+		public:
+			explicit mapped_file(const char* path);
+			~mapped_file();
+
+			mapped_file(const mapped_file&) = delete;
+
+			inline bool is_open() {
+				return this->open;
+			}
+
+			inline const char* get_data() {
+				return this->data;
+			}
+
+			inline unsigned long get_length() {
+				return this->length;
+			}
+		};
+	}
+}
+
+#endif // !MAPPED_FILE_H
\ No newline at end of file
@@ -0,0 +1,447 @@
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <random>
+#include <utility>
+#include <unordered_map>
+#include "errors.h"
+#include "hash.h"
+#include "operators.h"
+#include "structure.h"
+#include "mapped_file.h"
+#include "module.h"
+
+namespace fastcode {
+	namespace parsing {
+		static const char module_magic[4] = { 'F', 'C', 'C', 'M' };
+
+		void module_writer::write_symbol(unsigned int symbol_id) {
+			auto it = this->symbol_indices.find(symbol_id);
+			if (it != this->symbol_indices.end()) {
+				write_u32(it->second);
+				return;
+			}
+			unsigned int index = (unsigned int)this->symbols.size();
+			this->symbol_indices[symbol_id] = index;
+			this->symbols.push_back(symbol_id);
+			write_u32(index);
+		}
+
+		void module_writer::write_symbol_table(const module_writer& body) {
+			write_u32((unsigned int)body.symbols.size());
+			for (auto it = body.symbols.begin(); it != body.symbols.end(); ++it) {
+				const char* name = get_symbols().get_name(*it);
+				write_string(name, (unsigned long)std::strlen(name));
+			}
+		}
+
+		void module_writer::write_value(value* value) {
+			if (value == nullptr) {
+				write_u8(MODULE_NO_VALUE);
+				return;
+			}
+			write_u8(value->type);
+			switch (value->type)
+			{
+			case VALUE_TYPE_NULL:
+				break;
+			case VALUE_TYPE_CHAR:
+				write_u8((unsigned char)*value->get_char());
+				break;
+			case VALUE_TYPE_NUMERICAL:
+				this->buffer.append((const char*)value->get_numerical(), sizeof(long double));
+				break;
+			default:
+				throw ERROR_INVALID_VALUE_TYPE;
+			}
+		}
+
+		void module_writer::write_token(token* tok) {
+			if (tok == nullptr) {
+				write_u8(MODULE_NULL_TOKEN);
+				return;
+			}
+			write_u8(tok->type);
+			switch (tok->type)
+			{
+			case TOKEN_VALUE: {
+				value val = ((value_token*)tok)->copy_value();
+				write_value(&val);
+				break;
+			}
+			case TOKEN_IDENTIFIER:
+				write_symbol(((identifier_token*)tok)->symbol_id);
+				break;
+			case TOKEN_VAR_ACCESS:
+				write_tokens(((variable_access_token*)tok)->modifiers);
+				break;
+			case TOKEN_INDEX:
+				write_token(((index_token*)tok)->value);
+				break;
+			case TOKEN_GET_REFERENCE:
+				write_token(((get_reference_token*)tok)->var_access);
+				break;
+			case TOKEN_BINARY_OP: {
+				binary_operator_token* binary_op = (binary_operator_token*)tok;
+				write_u8(binary_op->op);
+				write_token(binary_op->left);
+				write_token(binary_op->right);
+				break;
+			}
+			case TOKEN_UNARY_OP:
+				write_u8(((unary_operator_token*)tok)->op);
+				write_token(((unary_operator_token*)tok)->value);
+				break;
+			case TOKEN_SET: {
+				set_token* set = (set_token*)tok;
+				write_u8(set->create_static);
+				write_token(set->destination);
+				write_token(set->value);
+				break;
+			}
+			case TOKEN_FUNCTION_CALL:
+				write_token(((function_call_token*)tok)->identifier);
+				write_tokens(((function_call_token*)tok)->arguments);
+				break;
+			case TOKEN_RETURN:
+				write_token(((return_token*)tok)->value);
+				break;
+			case TOKEN_BREAK:
+				break;
+			case TOKEN_IF:
+			case TOKEN_ELIF:
+			case TOKEN_ELSE:
+			case TOKEN_WHILE: {
+				conditional_token* conditional = (conditional_token*)tok;
+				write_token(conditional->condition);
+				write_tokens(conditional->instructions);
+				write_token(conditional->next);
+				break;
+			}
+			case TOKEN_FOR: {
+				for_token* for_tok = (for_token*)tok;
+				write_token(for_tok->identifier);
+				write_token(for_tok->collection);
+				write_tokens(for_tok->instructions);
+				break;
+			}
+			case TOKEN_CREATE_ARRAY: {
+				create_array_token* create_array = (create_array_token*)tok;
+				write_u8(create_array->string != nullptr);
+				if (create_array->string != nullptr)
+					write_string(create_array->string, create_array->string_length);
+				else
+					write_tokens(create_array->values);
+				break;
+			}
+			case TOKEN_CREATE_STRUCT:
+				write_token(((create_struct_token*)tok)->identifier);
+				break;
+			case TOKEN_STRUCT_PROTO: {
+				structure_prototype* proto = (structure_prototype*)tok;
+				write_token(proto->identifier);
+				write_tokens(proto->get_properties());
+				break;
+			}
+			case TOKEN_FUNC_PROTO: {
+				function_prototype* proto = (function_prototype*)tok;
+				write_token(proto->identifier);
+				write_tokens(proto->argument_identifiers);
+				write_tokens(proto->tokens);
+				write_u8(proto->params_mode);
+				break;
+			}
+			case TOKEN_INCLUDE: {
+				const char* file_path = ((include_token*)tok)->get_file_path();
+				write_string(file_path, (unsigned long)std::strlen(file_path));
+				break;
+			}
+			default:
+				throw ERROR_UNEXPECTED_TOKEN;
+			}
+		}
+
+		char* module_reader::read_string(unsigned long* length) {
+			*length = read_u32();
+			const char* bytes = read_bytes(*length);
+			char* string = new char[*length + 1];
+			std::memcpy(string, bytes, *length);
+			string[*length] = 0;
+			return string;
+		}
+
+		void module_reader::read_symbol_table() {
+			unsigned int symbol_count = read_u32();
+			for (unsigned int i = 0; i < symbol_count; i++) {
+				unsigned int name_length = read_u32();
+				const char* name = read_bytes(name_length);
+				this->symbols.push_back(get_symbols().intern(name, name_length, insecure_hash(name, name_length)));
+			}
+		}
+
+		unsigned int module_reader::read_symbol() {
+			unsigned int index = read_u32();
+			if (index >= this->symbols.size())
+				throw ERROR_UNRECOGNIZED_VARIABLE;
+			return this->symbols[index];
+		}
+
+		value* module_reader::read_value(unsigned char type) {
+			switch (type)
+			{
+			case MODULE_NO_VALUE:
+				return nullptr;
+			case VALUE_TYPE_NULL:
+				return new value(VALUE_TYPE_NULL, nullptr);
+			case VALUE_TYPE_CHAR:
+				return new value((char)read_u8());
+			case VALUE_TYPE_NUMERICAL: {
+				long double numerical;
+				std::memcpy(&numerical, read_bytes(sizeof(long double)), sizeof(long double));
+				return new value(numerical);
+			}
+			default:
+				throw ERROR_INVALID_VALUE_TYPE;
+			}
+		}
+
+		std::vector<token*> module_reader::read_tokens() {
+			std::vector<token*> tokens;
+			unsigned int count = read_u32();
+			for (unsigned int i = 0; i < count; i++)
+				tokens.push_back(read_token());
+			return tokens;
+		}
+
+		identifier_token* module_reader::read_identifier() {
+			token* tok = read_token();
+			if (tok == nullptr || tok->type != TOKEN_IDENTIFIER)
+				throw ERROR_UNEXPECTED_TOKEN;
+			return (identifier_token*)tok;
+		}
+
+		std::vector<identifier_token*> module_reader::read_identifiers() {
+			std::vector<identifier_token*> identifiers;
+			unsigned int count = read_u32();
+			for (unsigned int i = 0; i < count; i++)
+				identifiers.push_back(read_identifier());
+			return identifiers;
+		}
+
+		variable_access_token* module_reader::read_var_access() {
+			token* tok = read_token();
+			if (tok == nullptr || tok->type != TOKEN_VAR_ACCESS)
+				throw ERROR_UNEXPECTED_TOKEN;
+			return (variable_access_token*)tok;
+		}
+
+		token* module_reader::read_required_token() {
+			token* tok = read_token();
+			if (tok == nullptr)
+				throw ERROR_UNEXPECTED_TOKEN;
+			return tok;
+		}
+
+		token* module_reader::read_token() {
+			unsigned char type = read_u8();
+			switch (type)
+			{
+			case MODULE_NULL_TOKEN:
+				return nullptr;
+			case TOKEN_VALUE: {
+				value* val = read_value();
+				if (val == nullptr)
+					throw ERROR_INVALID_VALUE_TYPE;
+				return new value_token(val);
+			}
+			case TOKEN_IDENTIFIER:
+				return new identifier_token(read_symbol());
+			case TOKEN_VAR_ACCESS:
+				return new variable_access_token(read_tokens());
+			case TOKEN_INDEX:
+				return new index_token(read_required_token());
+			case TOKEN_GET_REFERENCE:
+				return new get_reference_token(read_var_access());
+			case TOKEN_BINARY_OP: {
+				unsigned char op = read_u8();
+				token* left = read_required_token();
+				token* right = read_required_token();
+				return new binary_operator_token(left, right, op);
+			}
+			case TOKEN_UNARY_OP: {
+				unsigned char op = read_u8();
+				return new unary_operator_token(read_required_token(), op);
+			}
+			case TOKEN_SET: {
+				bool create_static = read_u8();
+				variable_access_token* destination = read_var_access();
+				return new set_token(destination, read_required_token(), create_static);
+			}
+			case TOKEN_FUNCTION_CALL: {
+				identifier_token* identifier = read_identifier();
+				return new function_call_token(identifier, read_tokens());
+			}
+			case TOKEN_RETURN:
+				return new return_token(read_required_token());
+			case TOKEN_BREAK:
+				return new token(TOKEN_BREAK);
+			case TOKEN_IF:
+			case TOKEN_ELIF:
+			case TOKEN_ELSE:
+			case TOKEN_WHILE: {
+				token* condition = read_token();
+				std::vector<token*> instructions = read_tokens();
+				token* next = read_token();
+				if (next != nullptr && next->type != TOKEN_ELIF && next->type != TOKEN_ELSE)
+					throw ERROR_UNEXPECTED_TOKEN;
+				return new conditional_token(type, condition, instructions, (conditional_token*)next);
+			}
+			case TOKEN_FOR: {
+				identifier_token* identifier = read_identifier();
+				token* collection = read_required_token();
+				return new for_token(identifier, collection, read_tokens());
+			}
+			case TOKEN_CREATE_ARRAY: {
+				if (read_u8()) {
+					unsigned long string_length;
+					char* string = read_string(&string_length);
+					return new create_array_token(string, string_length);
+				}
+				return new create_array_token(read_tokens());
+			}
+			case TOKEN_CREATE_STRUCT:
+				return new create_struct_token(read_identifier());
+			case TOKEN_STRUCT_PROTO: {
+				identifier_token* identifier = read_identifier();
+				return new structure_prototype(identifier, read_identifiers());
+			}
+			case TOKEN_FUNC_PROTO: {
+				identifier_token* identifier = read_identifier();
+				std::vector<identifier_token*> argument_identifiers = read_identifiers();
+				std::vector<token*> tokens = read_tokens();
+				return new function_prototype(identifier, argument_identifiers, tokens, read_u8());
+			}
+			case TOKEN_INCLUDE: {
+				unsigned long path_length;
+				return new include_token(read_string(&path_length));
+			}
+			default:
+				throw ERROR_UNRECOGNIZED_TOKEN;
+			}
+		}
+
+		bool write_file(const char* path, const module_writer& header, const module_writer& body) {
+			std::string temp_path = std::string(path) + '.' + std::to_string(std::random_device()());
+			std::ofstream outfile(temp_path, std::ofstream::binary);
+			if (!outfile.is_open())
+				return false;
+			outfile.write(header.buffer.data(), header.buffer.size());
+			outfile.write(body.buffer.data(), body.buffer.size());
+			outfile.close();
+			if (outfile.fail()) {
+				std::remove(temp_path.c_str());
+				return false;
+			}
+			if (std::rename(temp_path.c_str(), path) != 0) {
+				std::remove(path);
+				if (std::rename(temp_path.c_str(), path) != 0) {
+					std::remove(temp_path.c_str());
+					return false;
+				}
+			}
+			return true;
+		}
+
+		//checks if a looked up constant still has the same value, or is still not a constant
+		static bool same_constant(value* recorded, value_token* current) {
+			if (recorded == nullptr || current == nullptr)
+				return recorded == nullptr && current == nullptr;
+			value current_value = current->copy_value();
+			return recorded->type == current_value.type && recorded->compare(&current_value) == 0;
+		}
+
+		bool save_module(const char* cache_path, const char* source, unsigned long source_length, const std::vector<token*>& tokens, struct lexer::lexer_state* lexer_state, struct lexer::lexer_state::constant_log* log) {
+			module_writer body;
+			try {
+				body.write_u32((unsigned int)log->lookups.size());
+				for (auto it = log->lookups.begin(); it != log->lookups.end(); ++it) {
+					body.write_symbol(it->first);
+					body.write_value(it->second);
+				}
+				body.write_u32((unsigned int)log->definitions.size());
+				for (auto it = log->definitions.begin(); it != log->definitions.end(); ++it) {
+					value constant = lexer_state->constants[*it]->copy_value();
+					body.write_symbol(*it);
+					body.write_value(&constant);
+				}
+				body.write_tokens(tokens);
+			}
+			catch (int) {
+				return false;
+			}
+
+			module_writer header;
+			header.buffer.append(module_magic, sizeof(module_magic));
+			header.write_u8(MODULE_FORMAT_VERSION);
+			header.write_u8(sizeof(long double));
+			header.write_u64(source_length);
+			header.write_u64(insecure_hash(source, source_length));
+			header.write_symbol_table(body);
+			return write_file(cache_path, header, body);
+		}
+
+		bool load_module(const char* cache_path, const char* source, unsigned long source_length, struct lexer::lexer_state* lexer_state, std::vector<token*>& tokens) {
+			mapped_file cache(cache_path);
+			if (!cache.is_open())
+				return false;
+
+			module_reader reader(cache.get_data(), cache.get_length());
+			std::vector<std::pair<unsigned int, value*>> definitions;
+			try {
+				if (std::memcmp(reader.read_bytes(sizeof(module_magic)), module_magic, sizeof(module_magic)) != 0 ||
+					reader.read_u8() != MODULE_FORMAT_VERSION ||
+					reader.read_u8() != sizeof(long double) ||
+					reader.read_u64() != source_length ||
+					reader.read_u64() != (unsigned long long)insecure_hash(source, source_length))
+					return false;
+
+				reader.read_symbol_table();
+
+				unsigned int lookup_count = reader.read_u32();
+				for (unsigned int i = 0; i < lookup_count; i++) {
+					unsigned int symbol_id = reader.read_symbol();
+					value* recorded = reader.read_value();
+					auto it = lexer_state->constants.find(symbol_id);
+					bool same = same_constant(recorded, it == lexer_state->constants.end() ? nullptr : it->second);
+					delete recorded;
+					if (!same)
+						return false;
+				}
+
+				unsigned int definition_count = reader.read_u32();
+				for (unsigned int i = 0; i < definition_count; i++) {
+					unsigned int symbol_id = reader.read_symbol();
+					definitions.push_back(std::make_pair(symbol_id, reader.read_value()));
+					if (definitions.back().second == nullptr)
+						throw ERROR_INVALID_VALUE_TYPE;
+				}
+
+				tokens = reader.read_tokens();
+				if (!reader.at_end())
+					throw ERROR_UNEXPECTED_TOKEN;
+			}
+			catch (int) {
+				//a corrupted module is recompiled, though the tokens read before the corruption aren't freed
+				for (auto it = definitions.begin(); it != definitions.end(); ++it)
+					delete it->second;
+				return false;
+			}
+
+			for (auto it = definitions.begin(); it != definitions.end(); ++it)
+				lexer_state->define_constant(it->first, new value_token(it->second));
+			return true;
+		}
+	}
+}
\ No newline at end of file
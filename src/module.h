@@ -0,0 +1,161 @@
+#pragma once
+
+#ifndef MODULE_H
+#define MODULE_H
+
+#include <list>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <unordered_map>
+#include "errors.h"
+#include "tokens.h"
+#include "lexer.h"
+
+//appended to an included file's path to get the path of it's cached module
+#define MODULE_CACHE_EXTENSION ".fcc"
+
+//bumped whenever the module format or the tokens it holds change
+#define MODULE_FORMAT_VERSION 1
+
+//marks a missing token, such as an else's condition
+#define MODULE_NULL_TOKEN 0xFF
+
+//marks a looked up identifier that wasn't a constant
+#define MODULE_NO_VALUE 0xFF
+
+namespace fastcode {
+	namespace parsing {
+		//a module cache holds a source file's lexed tokens, so including the file again can skip lexing it
+		//it's keyed by the source's length and hash, and by the constants the source looked up when it was lexed, since they were substituted into it's tokens
+		//symbols are stored by name, because symbol ids differ from one run to the next
+
+		//serializes tokens into a byte buffer, collecting the symbols they use into a table
+		class module_writer {
+		private:
+			std::unordered_map<unsigned int, unsigned int> symbol_indices;
+
+		public:
+			std::vector<unsigned int> symbols;
+			std::string buffer;
+
+			inline void write_u8(unsigned char byte) {
+				this->buffer.push_back((char)byte);
+			}
+
+			inline void write_u32(unsigned int number) {
+				this->buffer.append((const char*)&number, sizeof(unsigned int));
+			}
+
+			inline void write_u64(unsigned long long number) {
+				this->buffer.append((const char*)&number, sizeof(unsigned long long));
+			}
+
+			inline void write_string(const char* string, unsigned long length) {
+				write_u32((unsigned int)length);
+				this->buffer.append(string, length);
+			}
+
+			void write_symbol(unsigned int symbol_id);
+
+			//writes the names of the symbols another writer collected, which have to precede it
+			void write_symbol_table(const module_writer& body);
+
+			//only primitive values can be written, since they're the only ones tokens hold
+			void write_value(value* value);
+
+			template<typename T>
+			void write_tokens(const std::vector<T*>& tokens) {
+				write_u32((unsigned int)tokens.size());
+				for (auto it = tokens.begin(); it != tokens.end(); ++it)
+					write_token(*it);
+			}
+
+			void write_token(token* tok);
+		};
+
+		//deserializes tokens, bounds checking every read so a truncated or corrupted module is rejected rather than trusted
+		class module_reader {
+		private:
+			const char* data;
+			unsigned long length;
+			unsigned long position;
+
+		public:
+			std::vector<unsigned int> symbols;
+
+			module_reader(const char* data, unsigned long length) {
+				this->data = data;
+				this->length = length;
+				this->position = 0;
+			}
+
+			inline bool at_end() {
+				return this->position == this->length;
+			}
+
+			inline const char* read_bytes(unsigned long count) {
+				if (count > this->length - this->position)
+					throw ERROR_UNEXPECTED_END;
+				const char* bytes = this->data + this->position;
+				this->position += count;
+				return bytes;
+			}
+
+			inline unsigned char read_u8() {
+				return (unsigned char)*read_bytes(1);
+			}
+
+			inline unsigned int read_u32() {
+				unsigned int number;
+				std::memcpy(&number, read_bytes(sizeof(unsigned int)), sizeof(unsigned int));
+				return number;
+			}
+
+			inline unsigned long long read_u64() {
+				unsigned long long number;
+				std::memcpy(&number, read_bytes(sizeof(unsigned long long)), sizeof(unsigned long long));
+				return number;
+			}
+
+			//reads a length prefixed string into a new, null terminated buffer
+			char* read_string(unsigned long* length);
+
+			//reads the symbol names written by write_symbol_table, interning them
+			void read_symbol_table();
+
+			unsigned int read_symbol();
+
+			//reads a value, or null if the value was missing
+			inline value* read_value() {
+				return read_value(read_u8());
+			}
+
+			//reads a value whose type has already been read
+			value* read_value(unsigned char type);
+
+			std::vector<token*> read_tokens();
+			identifier_token* read_identifier();
+			std::vector<identifier_token*> read_identifiers();
+			variable_access_token* read_var_access();
+
+			//reads a token that can't be missing
+			token* read_required_token();
+
+			//tokens are rebuilt through their constructors, which check that their children are of the right kinds
+			token* read_token();
+		};
+
+		//writes a file through a uniquely named temporary file that's renamed over it, so concurrent runs never see it half written
+		bool write_file(const char* path, const module_writer& header, const module_writer& body);
+
+		//writes a lexed file's module cache, returns false if it couldn't be written
+		bool save_module(const char* cache_path, const char* source, unsigned long source_length, const std::vector<token*>& tokens, struct lexer::lexer_state* lexer_state, struct lexer::lexer_state::constant_log* log);
+
+		//loads a module cache if it's compiled from the same source, and the constants it depends on haven't changed; the constants the module defines are defined again
+		//returns false if the cache is missing, stale or malformed
+		bool load_module(const char* cache_path, const char* source, unsigned long source_length, struct lexer::lexer_state* lexer_state, std::vector<token*>& tokens);
+	}
+}
+
+#endif // !MODULE_H
\ No newline at end of file
@@ -1,8 +1,19 @@
+#include <new>
+#include <cstring>
+#include <utility>
+#include <set>
+#include <vector>
+#include <algorithm>
 #include "hash.h"
 #include "structure.h"
 #include "collection.h"
+#include "table.h"
 #include "references.h"
 #include "garbage.h"
+#include "slab.h"
+
+//how many nested objects a comparison tracks in a list before it starts using a set
+#define COMPARE_SHALLOW_DEPTH 32
 
 namespace fastcode {
 	namespace parsing {
@@ -10,18 +21,17 @@ namespace fastcode {
 			this->identifier = new identifier_token(identifier);
 			this->property_count = property_count;
 			for (unsigned int i = 0; i < property_count; i++) {
-				identifier_token* prop = new identifier_token(identifier);
-				this->property_indicies[prop->id_hash] = i;
+				identifier_token* prop = new identifier_token(properties[i]);
+				this->property_symbols.push_back(prop->symbol_id);
 				this->properties.push_back(prop);
 			}
 		}
 
-		structure_prototype::structure_prototype(identifier_token* identifier, std::list<identifier_token*> properties) : token(TOKEN_STRUCT_PROTO) {
+		structure_prototype::structure_prototype(identifier_token* identifier, const std::vector<identifier_token*>& properties) : token(TOKEN_STRUCT_PROTO) {
 			this->identifier = identifier;
 			this->property_count = properties.size();
-			unsigned int index = 0;
 			for (auto i = properties.begin(); i != properties.end(); ++i)
-				this->property_indicies[(*i)->id_hash] = index++;
+				this->property_symbols.push_back((*i)->symbol_id);
 			this->properties = properties;
 		}
 
@@ -33,13 +43,31 @@ namespace fastcode {
 	}
 
 	namespace runtime {
-		structure::structure(parsing::structure_prototype* prototype, garbage_collector* gc) : structure(prototype, gc->new_apartment(new value(VALUE_TYPE_STRUCT, this))) {
+		static slab structure_slab(sizeof(structure));
+		static slab collection_slab(sizeof(collection));
+
+		//a derived object wouldn't fit in a slot, so it falls back to the global heap
+		void* structure::operator new(std::size_t size) {
+			if (size != sizeof(structure))
+				return ::operator new(size);
+			return structure_slab.allocate();
+		}
+
+		void structure::operator delete(void* ptr, std::size_t size) {
+			if (size != sizeof(structure))
+				::operator delete(ptr);
+			else
+				structure_slab.release(ptr);
+		}
+
+		structure::structure(parsing::structure_prototype* prototype, garbage_collector* gc) : structure(prototype, gc->new_apartment(new value(VALUE_TYPE_STRUCT, this)), gc) {
 			for (unsigned int i = 0; i < prototype->property_count; i++)
 				this->properties[i] = gc->new_apartment(new value(VALUE_TYPE_NULL, nullptr));
 		}
 
-		structure::structure(parsing::structure_prototype* prototype, reference_apartment* parent_reference) {
+		structure::structure(parsing::structure_prototype* prototype, reference_apartment* parent_reference, garbage_collector* gc) {
 			this->parent_reference = parent_reference;
+			this->gc = gc;
 			this->prototype = prototype;
 			this->properties = new reference_apartment * [prototype->property_count];
 		}
@@ -48,26 +76,20 @@ namespace fastcode {
 			delete[] this->properties;
 		}
 		
-		void structure::set_reference(unsigned long id_hash, reference_apartment* reference) {
-			unsigned int index = prototype->get_index(id_hash);
-			this->properties[index]->remove_parent_references(parent_reference);
-			reference->add_parent_references(parent_reference);
-			this->properties[index] = reference;
+		void structure::set_reference(unsigned int symbol_id, reference_apartment* reference) {
+			gc->write_barrier(parent_reference, reference);
+			this->properties[prototype->get_index(symbol_id)] = reference;
 		}
 
 		void structure::set_reference_at(unsigned int index, reference_apartment* reference) {
-			this->properties[index]->remove_parent_references(parent_reference);
-			reference->add_parent_references(parent_reference);
+			gc->write_barrier(parent_reference, reference);
 			this->properties[index] = reference;
 		}
 
 		structure* structure::clone(reference_apartment* parent_reference) {
-			structure* kopy = new structure(this->prototype, parent_reference);
+			structure* kopy = new structure(this->prototype, parent_reference, gc);
 			for (unsigned int i = 0; i < this->prototype->property_count; i++)
-			{
-				kopy->properties[i] = this->properties[i];
-				this->properties[i]->add_parent_references(parent_reference);
-			}
+				kopy->set_reference_at(i, this->properties[i]);
 			return kopy;
 		}
 
@@ -80,62 +102,487 @@ namespace fastcode {
 			return hash;
 		}
 
-		collection::collection(unsigned long size, garbage_collector* gc) : collection(size, gc->new_apartment(new value(VALUE_TYPE_COLLECTION, this))) {
+		void* collection::operator new(std::size_t size) {
+			if (size != sizeof(collection))
+				return ::operator new(size);
+			return collection_slab.allocate();
+		}
+
+		void collection::operator delete(void* ptr, std::size_t size) {
+			if (size != sizeof(collection))
+				::operator delete(ptr);
+			else
+				collection_slab.release(ptr);
+		}
+
+		collection::collection(unsigned long size, garbage_collector* gc) {
+			this->size = size;
+			this->capacity = size;
+			this->gc = gc;
+			this->inner_collection = nullptr;
+			this->string = nullptr;
+			this->string_hashed = false;
+			this->viewed_reference = nullptr;
+			this->packed_collection = (value*)::operator new(sizeof(value) * size);
 			for (unsigned long i = 0; i < size; i++)
-			{
-				this->inner_collection[i] = gc->new_apartment(new value(VALUE_TYPE_NULL, nullptr));
-			}
+				::new (&this->packed_collection[i]) value(VALUE_TYPE_NULL, nullptr);
+			this->parent_reference = gc->new_apartment(new value(VALUE_TYPE_COLLECTION, this));
 		}
 
-		collection::collection(collection* a, collection* b, reference_apartment* parent_reference) : collection(a->size + b->size, parent_reference) {
-			for (unsigned int i = 0; i < a->size; i++)
-			{
-				this->inner_collection[i] = a->inner_collection[i];
-				this->inner_collection[i]->add_parent_references(parent_reference);
+		collection::collection(collection* a, collection* b, reference_apartment* parent_reference) {
+			this->size = a->size + b->size;
+			this->capacity = this->size;
+			this->gc = a->gc;
+			this->parent_reference = parent_reference;
+			this->packed_collection = nullptr;
+			this->string = nullptr;
+			this->string_hashed = false;
+			this->viewed_reference = nullptr;
+
+			//concatenated strings are copied
+			if (a->get_string() != nullptr && b->get_string() != nullptr) {
+				this->inner_collection = nullptr;
+				this->string = new char[this->size + 1];
+				std::memcpy(this->string, a->get_string(), a->size);
+				std::memcpy(this->string + a->size, b->get_string(), b->size);
+				this->string[this->size] = 0;
+				return;
 			}
+
+			//other collections share their elements with both operands, so the operands are boxed
+			this->inner_collection = new reference_apartment * [this->size];
+			for (unsigned int i = 0; i < a->size; i++)
+				set_reference(i, a->get_reference(i));
 			for (unsigned int i = 0; i < b->size; i++)
-			{
-				this->inner_collection[a->size + i] = b->inner_collection[i];
-				b->inner_collection[i]->add_parent_references(parent_reference);
+				set_reference(a->size + i, b->get_reference(i));
+		}
+
+		collection::collection(const char* string, unsigned long length, garbage_collector* gc) {
+			this->size = length;
+			this->gc = gc;
+			this->inner_collection = nullptr;
+			this->packed_collection = nullptr;
+			this->string = new char[length + 1];
+			this->capacity = length;
+			std::memcpy(this->string, string, length);
+			this->string[length] = 0;
+			this->string_hashed = false;
+			this->viewed_reference = nullptr;
+			this->parent_reference = gc->new_apartment(new value(VALUE_TYPE_COLLECTION, this));
+		}
+
+		collection::collection(collection* viewed, unsigned long offset, unsigned long length) {
+			this->size = length;
+			this->capacity = 0;
+			this->gc = viewed->gc;
+			this->inner_collection = nullptr;
+			this->packed_collection = nullptr;
+			this->string = nullptr;
+			this->string_hashed = false;
+
+			//views of views slice the underlying collection directly
+			if (viewed->is_view()) {
+				this->viewed_reference = viewed->viewed_reference;
+				this->view_offset = viewed->view_offset + offset;
+			}
+			else {
+				this->viewed_reference = viewed->parent_reference;
+				this->view_offset = offset;
 			}
+			this->parent_reference = gc->new_apartment(new value(VALUE_TYPE_COLLECTION, this));
+			gc->write_barrier(this->parent_reference, this->viewed_reference);
 		}
 
-		collection::collection(unsigned long size, reference_apartment* parent_reference) {
+		collection::collection(unsigned long size, reference_apartment* parent_reference, garbage_collector* gc) {
 			this->size = size;
+			this->capacity = size;
+			this->gc = gc;
 			this->parent_reference = parent_reference;
 			this->inner_collection = new reference_apartment * [size];
+			this->packed_collection = nullptr;
+			this->string = nullptr;
+			this->string_hashed = false;
+			this->viewed_reference = nullptr;
 		}
 
 		collection::~collection() {
-			delete this->inner_collection;
+			if (this->packed_collection != nullptr) {
+				for (unsigned long i = 0; i < size; i++)
+					this->packed_collection[i].~value();
+				::operator delete(this->packed_collection);
+			}
+			delete[] this->string;
+			delete[] this->inner_collection;
+		}
+
+		void collection::widen() {
+			this->packed_collection = (value*)::operator new(sizeof(value) * capacity);
+			for (unsigned long i = 0; i < size; i++)
+				::new (&this->packed_collection[i]) value(this->string[i]);
+			delete[] this->string;
+			this->string = nullptr;
+		}
+
+		void collection::append_string(const char* bytes, unsigned long length) {
+			if (this->size + length > this->capacity)
+				reserve(this->size + length > this->capacity * 2 ? this->size + length : this->capacity * 2);
+			std::memcpy(this->string + this->size, bytes, length);
+			this->size += length;
+			this->string[this->size] = 0;
+			this->string_hashed = false;
+		}
+
+		void collection::reserve(unsigned long new_capacity) {
+			if (new_capacity <= this->capacity)
+				return;
+			if (this->string != nullptr) {
+				char* new_string = new char[new_capacity + 1];
+				std::memcpy(new_string, this->string, this->size + 1);
+				delete[] this->string;
+				this->string = new_string;
+			}
+			if (this->packed_collection != nullptr) {
+				value* new_packed = (value*)::operator new(sizeof(value) * new_capacity);
+				for (unsigned long i = 0; i < size; i++) {
+					::new (&new_packed[i]) value(std::move(this->packed_collection[i]));
+					this->packed_collection[i].~value();
+				}
+				::operator delete(this->packed_collection);
+				this->packed_collection = new_packed;
+			}
+			if (this->inner_collection != nullptr) {
+				reference_apartment** new_inner = new reference_apartment * [new_capacity];
+				std::memcpy(new_inner, this->inner_collection, sizeof(reference_apartment*) * size);
+				delete[] this->inner_collection;
+				this->inner_collection = new_inner;
+			}
+			this->capacity = new_capacity;
+		}
+
+		void collection::push(value* element) {
+			if (this->string != nullptr && element->type != VALUE_TYPE_CHAR)
+				widen();
+			if (this->packed_collection != nullptr && !element->is_primitive())
+				box();
+			grow();
+			if (this->string != nullptr) {
+				this->string[this->size++] = element->character;
+				this->string[this->size] = 0;
+				this->string_hashed = false;
+				delete element;
+			}
+			else if (this->packed_collection != nullptr) {
+				if (this->inner_collection != nullptr)
+					this->inner_collection[this->size] = nullptr;
+				::new (&this->packed_collection[this->size++]) value(std::move(*element));
+				delete element;
+			}
+			else {
+				reference_apartment* reference = gc->new_apartment(element);
+				gc->write_barrier(parent_reference, reference);
+				this->inner_collection[this->size++] = reference;
+			}
+		}
+
+		void collection::push_reference(reference_apartment* reference) {
+			if (this->inner_collection == nullptr || this->packed_collection != nullptr)
+				box();
+			grow();
+			gc->write_barrier(parent_reference, reference);
+			this->inner_collection[this->size++] = reference;
+		}
+
+		reference_apartment* collection::pop() {
+			this->size--;
+			if (this->string != nullptr) {
+				reference_apartment* popped = gc->new_apartment(new value(this->string[this->size]));
+				this->string[this->size] = 0;
+				this->string_hashed = false;
+				return popped;
+			}
+			else if (this->packed_collection != nullptr) {
+				reference_apartment* popped = this->inner_collection == nullptr ? nullptr : this->inner_collection[this->size];
+				if (popped == nullptr)
+					popped = gc->new_apartment(new value(std::move(this->packed_collection[this->size])));
+				this->packed_collection[this->size].~value();
+				return popped;
+			}
+			return this->inner_collection[this->size];
+		}
+
+		void collection::move_last(unsigned long index) {
+			if (this->string != nullptr) {
+				char last = this->string[this->size - 1];
+				std::memmove(this->string + index + 1, this->string + index, this->size - 1 - index);
+				this->string[index] = last;
+				this->string_hashed = false;
+			}
+			else {
+				if (this->packed_collection != nullptr)
+					std::rotate(this->packed_collection + index, this->packed_collection + this->size - 1, this->packed_collection + this->size);
+				if (this->inner_collection != nullptr)
+					std::rotate(this->inner_collection + index, this->inner_collection + this->size - 1, this->inner_collection + this->size);
+			}
+		}
+
+		reference_apartment* collection::remove(unsigned long index) {
+			if (this->string != nullptr) {
+				char removed = this->string[index];
+				std::memmove(this->string + index, this->string + index + 1, this->size - index);
+				this->string_hashed = false;
+				this->size--;
+				return gc->new_apartment(new value(removed));
+			}
+			if (this->packed_collection != nullptr)
+				std::rotate(this->packed_collection + index, this->packed_collection + index + 1, this->packed_collection + this->size);
+			if (this->inner_collection != nullptr)
+				std::rotate(this->inner_collection + index, this->inner_collection + index + 1, this->inner_collection + this->size);
+			return pop();
+		}
+
+		void collection::box() {
+			if (this->string != nullptr)
+				widen();
+			if (this->inner_collection == nullptr) {
+				this->inner_collection = new reference_apartment * [capacity];
+				std::fill(this->inner_collection, this->inner_collection + size, nullptr);
+			}
+			for (unsigned long i = 0; i < size; i++)
+			{
+				if (this->inner_collection[i] == nullptr) {
+					this->inner_collection[i] = gc->new_apartment(new value(std::move(this->packed_collection[i])));
+					gc->write_barrier(parent_reference, this->inner_collection[i]);
+				}
+				this->packed_collection[i].~value();
+			}
+			::operator delete(this->packed_collection);
+			this->packed_collection = nullptr;
+		}
+
+		reference_apartment* collection::box(unsigned long index) {
+			if (this->string != nullptr)
+				widen();
+			if (this->inner_collection == nullptr) {
+				this->inner_collection = new reference_apartment * [capacity];
+				std::fill(this->inner_collection, this->inner_collection + size, nullptr);
+			}
+
+			//the boxed element leaves a null value behind in the packed storage
+			reference_apartment* reference = gc->new_apartment(new value(std::move(this->packed_collection[index])));
+			this->inner_collection[index] = reference;
+			return reference;
+		}
+
+		void collection::unbox(unsigned long index, reference_apartment* reference) {
+			if (this->viewed_reference != nullptr) {
+				value* viewed_value = this->viewed_reference->value;
+				if (viewed_value->type == VALUE_TYPE_COLLECTION && viewed_value->ptr != this)
+					((collection*)viewed_value->ptr)->unbox(this->view_offset + index, reference);
+				return;
+			}
+			if (this->packed_collection != nullptr && this->inner_collection != nullptr && index < this->size && this->inner_collection[index] == reference && !reference->is_shared() && reference->value->is_primitive()) {
+				this->packed_collection[index].assign_primitive(*reference->value);
+				this->inner_collection[index] = nullptr;
+			}
+			else
+				gc->write_barrier(parent_reference, reference); //the element may have been moved elsewhere in the collection, so the barrier's applied regardless
 		}
 
 		collection* collection::clone(reference_apartment* new_parent_apptr) {
-			collection* copy = new collection(this->size, new_parent_apptr);
+			collection* copy = new collection(this->size, new_parent_apptr, gc);
 			for (unsigned long i = 0; i < size; i++)
-				copy->inner_collection[i] = this->inner_collection[i];
+				copy->set_reference(i, get_reference(i));
 			return copy;
 		}
 
 		int collection::hash() {
 			int hash = 66; //magic number for collection hahses
+			const char* string = get_string();
+			if (string != nullptr) {
+				//a view's hash isn't cached, since the viewed string can change underneath it
+				if (this->string_hashed)
+					return this->string_hash;
+
+				//hashes the same as the string's chars would as values
+				for (unsigned long i = 0; i < this->size; i++)
+					hash = combine_hash(hash, int(string[i]));
+				if (this->viewed_reference == nullptr) {
+					this->string_hash = hash;
+					this->string_hashed = true;
+				}
+				return hash;
+			}
 			for (unsigned int i = 0; i < this->size; i++)
-				hash = combine_hash(hash, this->inner_collection[i]->value->hash());
+				hash = combine_hash(hash, get_value(i)->hash());
 			return hash;
 		}
 
+		//scrambles a value hash, since neighbouring keys tend to have neighbouring hashes
+		static inline unsigned int mix_hash(int hash) {
+			unsigned int mixed = (unsigned int)hash;
+			mixed ^= mixed >> 16;
+			mixed *= 0x45d9f3b;
+			mixed ^= mixed >> 16;
+			return mixed;
+		}
+
+		table::table(bool map, garbage_collector* gc) {
+			this->map = map;
+			this->gc = gc;
+			this->size = 0;
+			this->removed_slots = 0;
+			this->capacity = TABLE_MIN_CAPACITY;
+			this->entry_capacity = TABLE_MIN_CAPACITY / 2;
+			this->slots = new unsigned int[this->capacity]();
+			this->entries = new reference_apartment * [this->entry_capacity * get_stride()];
+			this->entry_hashes = new unsigned int[this->entry_capacity];
+			this->parent_reference = gc->new_apartment(new value(VALUE_TYPE_TABLE, this));
+		}
+
+		table::~table() {
+			delete[] this->slots;
+			delete[] this->entries;
+			delete[] this->entry_hashes;
+		}
+
+		unsigned int table::find_slot(value* key, unsigned int hash, bool* found) {
+			unsigned int mask = this->capacity - 1;
+			unsigned int slot = hash & mask;
+			unsigned int insert_slot = TABLE_SLOT_REMOVED;
+			while (true) {
+				unsigned int entry = this->slots[slot];
+				if (entry == TABLE_SLOT_EMPTY) {
+					*found = false;
+					return insert_slot == TABLE_SLOT_REMOVED ? slot : insert_slot;
+				}
+				if (entry == TABLE_SLOT_REMOVED) {
+					if (insert_slot == TABLE_SLOT_REMOVED)
+						insert_slot = slot;
+				}
+				else if (this->entry_hashes[entry - 1] == hash && keys_equal(get_key(entry - 1)->value, key)) {
+					*found = true;
+					return slot;
+				}
+				slot = (slot + 1) & mask;
+			}
+		}
+
+		unsigned int table::find_entry_slot(unsigned int entry, unsigned int hash) {
+			unsigned int mask = this->capacity - 1;
+			unsigned int slot = hash & mask;
+			while (this->slots[slot] != entry + 1)
+				slot = (slot + 1) & mask;
+			return slot;
+		}
+
+		void table::rehash(unsigned int new_capacity) {
+			delete[] this->slots;
+			this->capacity = new_capacity;
+			this->slots = new unsigned int[new_capacity]();
+			this->removed_slots = 0;
+			unsigned int mask = new_capacity - 1;
+			for (unsigned int i = 0; i < this->size; i++) {
+				unsigned int slot = this->entry_hashes[i] & mask;
+				while (this->slots[slot] != TABLE_SLOT_EMPTY)
+					slot = (slot + 1) & mask;
+				this->slots[slot] = i + 1;
+			}
+		}
+
+		long table::find(value* key) {
+			bool found;
+			unsigned int slot = find_slot(key, mix_hash(key->hash()), &found);
+			return found ? (long)this->slots[slot] - 1 : -1;
+		}
+
+		bool table::insert(reference_apartment* key, reference_apartment* value) {
+			unsigned int hash = mix_hash(key->value->hash());
+			bool found;
+			unsigned int slot = find_slot(key->value, hash, &found);
+			if (found) {
+				if (this->map) {
+					gc->write_barrier(parent_reference, value);
+					this->entries[(this->slots[slot] - 1) * 2 + 1] = value;
+				}
+				return false;
+			}
+
+			if (this->size == this->entry_capacity) {
+				unsigned int stride = get_stride();
+				unsigned int new_capacity = this->entry_capacity * 2;
+				reference_apartment** new_entries = new reference_apartment * [new_capacity * stride];
+				unsigned int* new_hashes = new unsigned int[new_capacity];
+				std::memcpy(new_entries, this->entries, sizeof(reference_apartment*) * this->size * stride);
+				std::memcpy(new_hashes, this->entry_hashes, sizeof(unsigned int) * this->size);
+				delete[] this->entries;
+				delete[] this->entry_hashes;
+				this->entries = new_entries;
+				this->entry_hashes = new_hashes;
+				this->entry_capacity = new_capacity;
+			}
+
+			unsigned int entry = this->size++;
+			if (this->slots[slot] == TABLE_SLOT_REMOVED)
+				this->removed_slots--;
+			this->slots[slot] = entry + 1;
+			this->entry_hashes[entry] = hash;
+			gc->write_barrier(parent_reference, key);
+			if (this->map) {
+				gc->write_barrier(parent_reference, value);
+				this->entries[entry * 2] = key;
+				this->entries[entry * 2 + 1] = value;
+			}
+			else
+				this->entries[entry] = key;
+
+			//the slots are kept at most three quarters full, counting removed markers
+			if ((this->size + this->removed_slots) * 4 > this->capacity * 3)
+				rehash(this->size * 2 > this->capacity ? this->capacity * 2 : this->capacity);
+			return true;
+		}
+
+		bool table::remove(value* key) {
+			bool found;
+			unsigned int slot = find_slot(key, mix_hash(key->hash()), &found);
+			if (!found)
+				return false;
+			unsigned int entry = this->slots[slot] - 1;
+			this->slots[slot] = TABLE_SLOT_REMOVED;
+			this->removed_slots++;
+			this->size--;
+
+			//the last entry fills the hole, so entries stay dense
+			if (entry != this->size) {
+				unsigned int stride = get_stride();
+				this->slots[find_entry_slot(this->size, this->entry_hashes[this->size])] = entry + 1;
+				this->entry_hashes[entry] = this->entry_hashes[this->size];
+				for (unsigned int i = 0; i < stride; i++)
+					this->entries[entry * stride + i] = this->entries[this->size * stride + i];
+			}
+			return true;
+		}
+
+		int table::hash() {
+			//identity, since tables are keyed by identity
+			return (int)(size_t)this;
+		}
+
 		//returns the inner refrence_apartment array. DO NOT DELETE 
 		reference_apartment** reference_apartment::get_children(unsigned int* children_size) {
 			if (value->type == VALUE_TYPE_COLLECTION) {
 				collection* collection = (class collection*)value->ptr;
-				*children_size = collection->size;
-				return collection->get_children();
+				return collection->get_children(children_size);
 			}
 			else if (value->type == VALUE_TYPE_STRUCT) {
 				structure* structure = (class structure*)value->ptr;
 				*children_size = structure->get_size();
 				return structure->get_children();
 			}
+			else if (value->type == VALUE_TYPE_TABLE) {
+				table* table = (class table*)value->ptr;
+				*children_size = table->size * table->get_stride();
+				return table->get_children();
+			}
 			return nullptr;
 		}
 	} 
@@ -146,10 +593,7 @@ namespace fastcode {
 		case VALUE_TYPE_NULL:
 			break;
 		case VALUE_TYPE_CHAR:
-			delete (char*)this->ptr;
-			break;
 		case VALUE_TYPE_NUMERICAL:
-			delete (long double*)this->ptr;
 			break;
 		case VALUE_TYPE_COLLECTION:
 			delete (runtime::collection*)this->ptr;
@@ -157,6 +601,9 @@ namespace fastcode {
 		case VALUE_TYPE_STRUCT:
 			delete (runtime::structure*)this->ptr;
 			break;
+		case VALUE_TYPE_TABLE:
+			delete (runtime::table*)this->ptr;
+			break;
 		case VALUE_TYPE_HANDLE:
 			break;
 		default:
@@ -168,17 +615,146 @@ namespace fastcode {
 		switch (this->type)
 		{
 		case VALUE_TYPE_CHAR:
-			return int(*(char*)this->ptr);
-		case VALUE_TYPE_NUMERICAL:
-			return int(*(long double*)this->ptr);
+			return int(this->character);
+		case VALUE_TYPE_NUMERICAL: {
+			//mixes the number's bits as a double, every bit affects the hash; -0 equals 0, so it's hashed like it
+			double number = (double)this->numerical;
+			if (number == 0)
+				return 0;
+			unsigned long long bits;
+			std::memcpy(&bits, &number, sizeof(bits));
+			bits ^= bits >> 33;
+			bits *= 0xff51afd7ed558ccdULL;
+			bits ^= bits >> 33;
+			return (int)(unsigned int)(bits ^ (bits >> 32));
+		}
 		case VALUE_TYPE_COLLECTION:
 			return ((runtime::collection*)this->ptr)->hash();
 		case VALUE_TYPE_STRUCT:
 			return ((runtime::structure*)this->ptr)->hash();
+		case VALUE_TYPE_TABLE:
+			return ((runtime::table*)this->ptr)->hash();
 		case VALUE_TYPE_HANDLE:
 			return int(this->ptr);
 		default:
 			throw ERROR_INVALID_VALUE_TYPE;
 		}
 	}
+
+	//gets a collection's element without widening strings
+	static inline value* peek_element(runtime::collection* collection, unsigned long index, value* buffer) {
+		if (collection->get_string() != nullptr) {
+			*buffer = value(collection->get_string()[index]);
+			return buffer;
+		}
+		return collection->get_value(index);
+	}
+
+	template<typename T>
+	static inline int compare_ordered(T a, T b) {
+		return (a > b) - (a < b);
+	}
+
+	//compares strings bytewise, memcmp finds whether they differ before the first differing char is located
+	static int compare_strings(const char* a, unsigned long a_size, const char* b, unsigned long b_size) {
+		unsigned long length = a_size < b_size ? a_size : b_size;
+		if (std::memcmp(a, b, length) != 0)
+			for (unsigned long i = 0; ; i++)
+				if (a[i] != b[i])
+					return a[i] - b[i];
+		return compare_ordered(a_size, b_size);
+	}
+
+	//the objects currently being compared, a pair that's reached again is part of a cycle and is taken to be equal
+	//the first few levels are scanned linearly, deeper ones are looked up in a set
+	struct compare_guard {
+		std::vector<std::pair<void*, void*>> shallow;
+		std::set<std::pair<void*, void*>> deep;
+
+		//returns false if the pair's already being compared
+		bool enter(void* a, void* b) {
+			std::pair<void*, void*> pair(a, b);
+			if (std::find(this->shallow.begin(), this->shallow.end(), pair) != this->shallow.end())
+				return false;
+			if (this->shallow.size() < COMPARE_SHALLOW_DEPTH) {
+				this->shallow.push_back(pair);
+				return true;
+			}
+			return this->deep.insert(pair).second;
+		}
+
+		void leave(void* a, void* b) {
+			if (this->deep.empty() || this->deep.erase(std::make_pair(a, b)) == 0)
+				this->shallow.pop_back();
+		}
+	};
+
+	static int compare_values(value* a, value* b, compare_guard& guard);
+
+	static int compare_collections(runtime::collection* col_a, runtime::collection* col_b, compare_guard& guard) {
+		if (col_a->get_string() != nullptr && col_b->get_string() != nullptr)
+			return compare_strings(col_a->get_string(), col_a->size, col_b->get_string(), col_b->size);
+
+		//elements are compared in order, stopping at the first difference
+		unsigned long length = col_a->size < col_b->size ? col_a->size : col_b->size;
+		value buffer_a(VALUE_TYPE_NULL, nullptr);
+		value buffer_b(VALUE_TYPE_NULL, nullptr);
+		for (unsigned long i = 0; i < length; i++) {
+			int result = compare_values(peek_element(col_a, i, &buffer_a), peek_element(col_b, i, &buffer_b), guard);
+			if (result != 0)
+				return result;
+		}
+		return compare_ordered(col_a->size, col_b->size);
+	}
+
+	static int compare_structures(runtime::structure* struct_a, runtime::structure* struct_b, compare_guard& guard) {
+		if (struct_a->get_identifier() != struct_b->get_identifier())
+			return compare_ordered(struct_a->get_identifier()->symbol_id, struct_b->get_identifier()->symbol_id);
+		for (unsigned int i = 0; i < struct_a->get_size(); i++) {
+			int result = compare_values(struct_a->get_children()[i]->value, struct_b->get_children()[i]->value, guard);
+			if (result != 0)
+				return result;
+		}
+		return 0;
+	}
+
+	static int compare_values(value* a, value* b, compare_guard& guard) {
+		//null orders before every other value
+		if (a->type == VALUE_TYPE_NULL)
+			return b->type == VALUE_TYPE_NULL ? 0 : -1;
+		else if (b->type == VALUE_TYPE_NULL)
+			return 1;
+
+		//chars compare with numericals by their char code
+		if (a->type == VALUE_TYPE_CHAR && b->type == VALUE_TYPE_NUMERICAL)
+			return compare_ordered((long double)a->character, b->numerical);
+		else if (a->type == VALUE_TYPE_NUMERICAL && b->type == VALUE_TYPE_CHAR)
+			return compare_ordered(*a->get_numerical(), (long double)b->character);
+		else if (a->type != b->type)
+			return a->type - b->type;
+
+		switch (a->type)
+		{
+		case VALUE_TYPE_COLLECTION:
+		case VALUE_TYPE_STRUCT: {
+			if (a->ptr == b->ptr || !guard.enter(a->ptr, b->ptr))
+				return 0;
+			int result = a->type == VALUE_TYPE_COLLECTION ? compare_collections((runtime::collection*)a->ptr, (runtime::collection*)b->ptr, guard) : compare_structures((runtime::structure*)a->ptr, (runtime::structure*)b->ptr, guard);
+			guard.leave(a->ptr, b->ptr);
+			return result;
+		}
+		case VALUE_TYPE_CHAR:
+			return a->character - b->character;
+		case VALUE_TYPE_NUMERICAL:
+			return compare_ordered(*a->get_numerical(), *b->get_numerical());
+		default:
+			//handles and tables are compared by identity
+			return compare_ordered(a->ptr, b->ptr);
+		}
+	}
+
+	int value::compare_objects(value* b) {
+		compare_guard guard;
+		return compare_values(this, b, guard);
+	}
 }
\ No newline at end of file
@@ -35,55 +35,55 @@ namespace fastcode {
 	}
 
 	namespace runtime {
-		value* evaluate_binary_op(unsigned char op, value* a, value* b) {
+		value evaluate_binary_op(unsigned char op, value* a, value* b) {
 			if (parsing::is_unary_operator(op))
 				throw ERROR_UNEXPECTED_TOKEN;
 			switch (op)
 			{
 			case OP_EQUALS:
-				return new value(VALUE_TYPE_NUMERICAL, new long double(a->compare(b) == 0 ? 1 : 0));
+				return value((long double)(a->compare(b) == 0 ? 1 : 0));
 			case OP_NOT_EQUAL:
-				return new value(VALUE_TYPE_NUMERICAL, new long double(a->compare(b) == 0 ? 0 : 1));
+				return value((long double)(a->compare(b) == 0 ? 0 : 1));
 			case OP_MORE:
-				return new value(VALUE_TYPE_NUMERICAL, new long double(a->compare(b) > 0 ? 1 : 0));
+				return value((long double)(a->compare(b) > 0 ? 1 : 0));
 			case OP_LESS:
-				return new value(VALUE_TYPE_NUMERICAL, new long double(a->compare(b) < 0 ? 1 : 0));
+				return value((long double)(a->compare(b) < 0 ? 1 : 0));
 			case OP_MORE_EQUAL:
-				return new value(VALUE_TYPE_NUMERICAL, new long double(a->compare(b) >= 0 ? 1 : 0));
+				return value((long double)(a->compare(b) >= 0 ? 1 : 0));
 			case OP_LESS_EQUAL:
-				return new value(VALUE_TYPE_NUMERICAL, new long double(a->compare(b) <= 0 ? 1 : 0));
+				return value((long double)(a->compare(b) <= 0 ? 1 : 0));
 			case OP_AND:
 				if (a->type != b->type)
 					throw ERROR_OP_NOT_IMPLEMENTED;
 				if (a->type != VALUE_TYPE_NUMERICAL)
 					throw ERROR_MUST_HAVE_NUM_TYPE;
-				return new value(VALUE_TYPE_NUMERICAL, new long double(*a->get_numerical() != 0 && *b->get_numerical() != 0 ? 1 : 0));
+				return value((long double)(*a->get_numerical() != 0 && *b->get_numerical() != 0 ? 1 : 0));
 			case OP_OR:
 				if (a->type != b->type)
 					throw ERROR_OP_NOT_IMPLEMENTED;
 				if (a->type != VALUE_TYPE_NUMERICAL)
 					throw ERROR_MUST_HAVE_NUM_TYPE;
-				return new value(VALUE_TYPE_NUMERICAL, new long double(*a->get_numerical() != 0 || *b->get_numerical() != 0 ? 1 : 0));
+				return value((long double)(*a->get_numerical() != 0 || *b->get_numerical() != 0 ? 1 : 0));
 			case OP_ADD:
 				if (a->type != b->type)
 					throw ERROR_OP_NOT_IMPLEMENTED;
 				if (a->type == VALUE_TYPE_NUMERICAL)
-					return new value(VALUE_TYPE_NUMERICAL, new long double(*a->get_numerical() + *b->get_numerical()));
+					return value(*a->get_numerical() + *b->get_numerical());
 				/*else if (a->type == VALUE_TYPE_COLLECTION)
-					return new value(VALUE_TYPE_COLLECTION, new collection((collection*)a->ptr, (collection*)b->ptr));*/
+					return value(VALUE_TYPE_COLLECTION, new collection((collection*)a->ptr, (collection*)b->ptr));*/
 				throw ERROR_OP_NOT_IMPLEMENTED;
 			case OP_SUBTRACT:
 				if (a->type != b->type)
 					throw ERROR_OP_NOT_IMPLEMENTED;
 				if (a->type != VALUE_TYPE_NUMERICAL)
 					throw ERROR_MUST_HAVE_NUM_TYPE;
-				return new value(VALUE_TYPE_NUMERICAL, new long double(*a->get_numerical() - *b->get_numerical()));
+				return value(*a->get_numerical() - *b->get_numerical());
 			case OP_MULTIPLY:
 				if (a->type != b->type)
 					throw ERROR_OP_NOT_IMPLEMENTED;
 				if (a->type != VALUE_TYPE_NUMERICAL)
 					throw ERROR_MUST_HAVE_NUM_TYPE;
-				return new value(VALUE_TYPE_NUMERICAL, new long double(*a->get_numerical() * *b->get_numerical()));
+				return value(*a->get_numerical() * *b->get_numerical());
 			case OP_DIVIDE:
 				if (a->type != b->type)
 					throw ERROR_OP_NOT_IMPLEMENTED;
@@ -91,51 +91,51 @@ namespace fastcode {
 					throw ERROR_MUST_HAVE_NUM_TYPE;
 				if (*b->get_numerical() == 0)
 					throw ERROR_DIVIDE_BY_ZERO;
-				return new value(VALUE_TYPE_NUMERICAL, new long double(*a->get_numerical() / *b->get_numerical()));
+				return value(*a->get_numerical() / *b->get_numerical());
 			case OP_MODULOUS:
 				if (a->type != b->type)
 					throw ERROR_OP_NOT_IMPLEMENTED;
 				if (a->type != VALUE_TYPE_NUMERICAL)
 					throw ERROR_MUST_HAVE_NUM_TYPE;
-				return new value(VALUE_TYPE_NUMERICAL, new long double(fmod(*a->get_numerical(), *b->get_numerical())));
+				return value((long double)fmod(*a->get_numerical(), *b->get_numerical()));
 			case OP_POWER:
 				if (a->type != b->type)
 					throw ERROR_OP_NOT_IMPLEMENTED;
 				if (a->type != VALUE_TYPE_NUMERICAL)
 					throw ERROR_MUST_HAVE_NUM_TYPE;
-				return new value(VALUE_TYPE_NUMERICAL, new long double(pow(*a->get_numerical(), *b->get_numerical())));
+				return value((long double)pow(*a->get_numerical(), *b->get_numerical()));
 			default:
 				throw ERROR_OP_NOT_IMPLEMENTED;
 			}
 		}
 
-		value* evaluate_unary_op(unsigned char op, value* a) {
+		value evaluate_unary_op(unsigned char op, value* a) {
 			if (!parsing::is_unary_operator(op))
 				throw ERROR_UNEXPECTED_TOKEN;
 			switch (op) {
 			case OP_INVERT:
 				/*if (a->type != VALUE_TYPE_NUMERICAL)
 					throw ERROR_MUST_HAVE_NUM_TYPE;*/
-				return new value(VALUE_TYPE_NUMERICAL, new long double(a->hash() == 0 ? 1 : 0));
+				if (a->type == VALUE_TYPE_NUMERICAL)
+					return value((long double)(*a->get_numerical() == 0 ? 1 : 0));
+				return value((long double)(a->hash() == 0 ? 1 : 0));
 			case OP_NEGATE:
 				if (a->type != VALUE_TYPE_NUMERICAL)
 					throw ERROR_MUST_HAVE_NUM_TYPE;
-				return new value(VALUE_TYPE_NUMERICAL, new long double(-*a->get_numerical()));
+				return value(-*a->get_numerical());
 			case OP_INCRIMENT: {
 				if (a->type != VALUE_TYPE_NUMERICAL)
 					throw ERROR_MUST_HAVE_NUM_TYPE;
-				long double* old_ptr = a->get_numerical();
-				long double* new_ptr = new long double(*old_ptr + 1);
-				a->ptr = new_ptr;
-				return new value(VALUE_TYPE_NUMERICAL, old_ptr);
+				long double old = a->numerical;
+				a->numerical = old + 1;
+				return value(old);
 			}
 			case OP_DECRIMENT: {
 				if (a->type != VALUE_TYPE_NUMERICAL)
 					throw ERROR_MUST_HAVE_NUM_TYPE;
-				long double* old_ptr = a->get_numerical();
-				long double* new_ptr = new long double(*old_ptr - 1);
-				a->ptr = new_ptr;
-				return new value(VALUE_TYPE_NUMERICAL, old_ptr);
+				long double old = a->numerical;
+				a->numerical = old - 1;
+				return value(old);
 			}
 			default:
 				throw ERROR_OP_NOT_IMPLEMENTED;
@@ -72,8 +72,8 @@ namespace fastcode {
 	}
 
 	namespace runtime {
-		value* evaluate_binary_op(unsigned char op, value* a, value* b);
-		value* evaluate_unary_op(unsigned char op, value* a);
+		value evaluate_binary_op(unsigned char op, value* a, value* b);
+		value evaluate_unary_op(unsigned char op, value* a);
 	}
 }
 #endif // !OPERATORS_H
\ No newline at end of file
@@ -9,7 +9,13 @@ namespace fastcode {
 	namespace runtime {
 		class reference_apartment {
 		private:
-			unsigned int references;
+			bool marked;
+			bool old;
+			bool remembered;
+
+			//whether the apartment has been referenced by anything besides the one variable it was lent to
+			bool shared;
+			unsigned int pins;
 			reference_apartment* next_apartment;
 
 			//gets the TOP level children, does NOT get it's childrens children
@@ -22,25 +28,35 @@ namespace fastcode {
 			reference_apartment(class value* value, reference_apartment* next_apartment = nullptr);
 			~reference_apartment();
 
-			//adds a reference to it and all it's child reference apartments
-			void add_reference();
-
-			//adds a reference to it and all it's child reference apartments, adds the amount of parent references
-			void add_parent_references(reference_apartment* parent);
+			//roots the apartment, keeping it alive while it is held outside of any variable or object
+			inline void pin() {
+				this->pins++;
+			}
 
-			//adds a reference to it and all it's child reference apartments
-			void remove_reference();
+			//releases a root added by pin
+			inline void unpin() {
+				this->pins--;
+			}
 
-			//adds a reference to it and all it's child reference apartments, removes the amount of parent references
-			void remove_parent_references(reference_apartment* parent);
+			//marks the apartment as referenced, so a lent element stays boxed
+			inline void share() {
+				this->shared = true;
+			}
 
-			//checks whether the reference apartment can be deleted
-			inline bool can_delete() {
-				return this->references == 0;
+			inline bool is_shared() {
+				return this->shared;
 			}
 
 			//sets the reference apartments value
 			void set_value(class value* value);
+
+			//sets the reference apartments value to a copy of a primitive value
+			inline void set_primitive(class value* value) {
+				if (this->value->is_primitive())
+					this->value->assign_primitive(*value);
+				else
+					set_value(value->clone());
+			}
 		};
 	}
 }
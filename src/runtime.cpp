@@ -1,41 +1,44 @@
-#include <fstream>
+#include <string>
 #include "collection.h"
 #include "operators.h"
 #include "garbage.h"
 #include "runtime.h"
 #include "hash.h"
+#include "mapped_file.h"
+#include "module.h"
+#include "image.h"
 
 //built in top-level functions
 #include "types.h"
 #include "io.h"
 #include "linq.h"
+#include "hashtable.h"
+#include "strlib.h"
 
 namespace fastcode {
 	namespace runtime {
-		interpreter::call_frame::call_frame(parsing::function_prototype* prototype, class garbage_collector* garbage_collector) {
-			this->prototype = prototype;
-			this->garbage_collector = garbage_collector;
-			garbage_collector->new_frame();
-			this->manager = new variable_manager(garbage_collector);
-		}
-
-		interpreter::call_frame::~call_frame() {
-			delete manager;
-			garbage_collector->sweep(true);
-		}
+		static const char image_magic[4] = { 'F', 'C', 'C', 'I' };
 
-		interpreter::interpreter(bool multi_sweep) {
-			this->multi_sweep = false;
-			this->break_mode = false;
+		interpreter::interpreter(bool multi_sweep, unsigned int gc_step_budget) : garbage_collector(multi_sweep ? GC_EAGER_NURSERY_SIZE : GC_NURSERY_SIZE, gc_step_budget) {
+			this->multi_sweep = multi_sweep;
+			this->definition_generation = 1;
 			static_var_manager = new variable_manager(&garbage_collector);
-			call_stack.push(new call_frame(nullptr, &garbage_collector));
-			new_constant("true", new value(VALUE_TYPE_NUMERICAL, new long double(1)));
-			new_constant("false", new value(VALUE_TYPE_NUMERICAL, new long double(0)));
+			global_var_manager = new variable_manager(&garbage_collector);
+			frame_stack = new variable_manager(&garbage_collector);
+			frame_stack->reserve(FRAME_STACK_RESERVE);
+			call_stack.reserve(CALL_STACK_RESERVE);
+			registers.reserve(REGISTER_STACK_RESERVE);
+			register_top = 0;
+			error_located = false;
+			call_stack.push_back(call_frame(nullptr, global_var_manager, 0));
+			new_constant("true", new value((long double)1));
+			new_constant("false", new value((long double)0));
 			new_constant("null", new value(VALUE_TYPE_NULL, nullptr));
-			new_constant("numtype", new value(VALUE_TYPE_CHAR, new char(VALUE_TYPE_NUMERICAL)));
-			new_constant("chartype", new value(VALUE_TYPE_CHAR, new char(VALUE_TYPE_CHAR)));
-			new_constant("coltype", new value(VALUE_TYPE_CHAR, new char(VALUE_TYPE_COLLECTION)));
-			new_constant("structtype", new value(VALUE_TYPE_CHAR, new char(VALUE_TYPE_STRUCT)));
+			new_constant("numtype", new value((char)VALUE_TYPE_NUMERICAL));
+			new_constant("chartype", new value((char)VALUE_TYPE_CHAR));
+			new_constant("coltype", new value((char)VALUE_TYPE_COLLECTION));
+			new_constant("structtype", new value((char)VALUE_TYPE_STRUCT));
+			new_constant("tabletype", new value((char)VALUE_TYPE_TABLE));
 			import_func("typeof", builtins::get_type);
 			import_func("num", builtins::to_numerical);
 			import_func("str", builtins::to_string);
@@ -45,6 +48,11 @@ namespace fastcode {
 			import_func("input", builtins::get_input);
 			import_func("array", builtins::allocate_array);
 			import_func("len", builtins::get_length);
+			import_func("push", builtins::push_element);
+			import_func("pop", builtins::pop_element);
+			import_func("insert", builtins::insert_element);
+			import_func("remove", builtins::remove_element);
+			import_func("slice", builtins::get_slice);
 			import_func("range", builtins::get_range);
 			import_func("handle", builtins::get_handle);
 			import_func("setprop", builtins::set_struct_property);
@@ -54,537 +62,871 @@ namespace fastcode {
 			import_func("read@file", builtins::file_read_text);
 			import_func("write@file", builtins::file_write_text);
 			import_func("count@linq", builtins::count_instances);
+			import_func("map", builtins::hashtable::new_map);
+			import_func("set@map", builtins::hashtable::map_set);
+			import_func("get@map", builtins::hashtable::map_get);
+			import_func("has@map", builtins::hashtable::map_has);
+			import_func("keys@map", builtins::hashtable::keys);
+			import_func("values@map", builtins::hashtable::map_values);
+			import_func("remove@map", builtins::hashtable::remove);
+			import_func("size@map", builtins::hashtable::size);
+			import_func("set", builtins::hashtable::new_set);
+			import_func("insert@set", builtins::hashtable::set_insert);
+			import_func("find@set", builtins::hashtable::set_find);
+			import_func("items@set", builtins::hashtable::keys);
+			import_func("remove@set", builtins::hashtable::remove);
+			import_func("size@set", builtins::hashtable::size);
+
+			//stl/strlib.txt is built on these, so they're imported for every interpreter rather than just the command line's
+			import_func("builder@strlib", builtins::strlib::builder);
+			import_func("append_c@strlib", builtins::strlib::append_c);
+			import_func("append@strlib", builtins::strlib::append);
+			import_func("build@strlib", builtins::strlib::build);
+			import_func("read_char@strlib", builtins::strlib::read_char);
+			import_func("read_till_c@strlib", builtins::strlib::read_till_c);
+			import_func("read_while@strlib", builtins::strlib::read_while);
+			import_func("read_till@strlib", builtins::strlib::read_till);
+			import_func("read_end@strlib", builtins::strlib::read_end);
 		}
 
 		interpreter::~interpreter() {
-			delete call_stack.top();
-			call_stack.pop();
+			call_stack.clear();
+			delete frame_stack;
+			delete global_var_manager;
 			delete static_var_manager;
 
 			for (auto it = this->function_definitions.begin(); it != this->function_definitions.end(); ++it) {
-				delete (*it).second;
+				delete *it;
 			}
 
 			for (auto it = this->struct_definitions.begin(); it != this->struct_definitions.end(); ++it) {
-				delete (*it).second;
+				delete *it;
 			}
 		}
 
-		long double interpreter::run(const char* source, bool interactive_mode) {
+		long double interpreter::run(const char* source, unsigned long source_length, bool interactive_mode) {
+			std::vector<parsing::token*> to_execute;
+			if (!tokenize(source, source_length, interactive_mode, to_execute))
+				return -1;
+			return run_tokens(to_execute, source, source_length);
+		}
+
+		bool interpreter::tokenize(const char* source, unsigned long source_length, bool interactive_mode, std::vector<parsing::token*>& tokens) {
 			parsing::lexer* lexer = nullptr;
-			std::list<parsing::token*> to_execute;
 			try {
-				lexer = new parsing::lexer(source, std::strlen(source), &lexer_state);
-				to_execute = lexer->tokenize(interactive_mode);
+				lexer = new parsing::lexer(source, source_length, &lexer_state);
+				tokens = lexer->tokenize(interactive_mode);
 				delete lexer;
+				return true;
 			}
 			catch (int syntax_err) {
 				//handle syntax error
 				last_error = syntax_err;
-				handle_syntax_err(syntax_err, lexer == nullptr ? 0 : lexer->get_pos(), source);
+				handle_syntax_err(syntax_err, lexer == nullptr ? 0 : lexer->get_pos(), source, source_length);
 				
 				delete lexer;
+				return false;
+			}
+		}
+
+		long double interpreter::run_tokens(std::vector<parsing::token*>& to_execute, const char* source, unsigned long source_length) {
+			parsing::bytecode* code;
+			try {
+				code = new parsing::bytecode(to_execute, &global_symbols);
+			}
+			catch (int syntax_err) {
+				last_error = syntax_err;
+				handle_syntax_err(syntax_err, 0, source, source_length);
 				return -1;
 			}
 
-			this->break_mode = false;
+			static_var_manager->expand(global_symbols.size());
+			global_var_manager->expand(global_symbols.size());
+
+			//code included from within a procedure still runs at the module level
+			bool nested = call_stack.size() > 1;
+			if (nested)
+				call_stack.push_back(call_frame(nullptr, global_var_manager, 0));
 
-			value_eval* ret_val;
+			long double exit_code = 0;
 			bool err = false;
+			unsigned int result = register_top++;
+			if (registers.size() < register_top)
+				registers.emplace_back();
 			try {
-				ret_val = execute_block(to_execute);
-				if (break_mode) {
-					throw ERROR_UNEXPECTED_BREAK;
-				}
+				execute(code, result);
+				value* ret_val = registers[result].get_value();
+				if (ret_val->type == VALUE_TYPE_NUMERICAL)
+					exit_code = *ret_val->get_numerical();
 			}
 			catch (int runtime_error) {
 				last_error = runtime_error;
+
+				//elements lent when the error was thrown stay boxed, their variables may still be around, but nothing else keeps them alive anymore
+				for (auto it = for_stack.begin(); it != for_stack.end(); ++it)
+					if (it->lent.element != nullptr) {
+						it->lent.element->share();
+						unbox(it->lent);
+					}
+				for (auto it = lent_arguments.begin(); it != lent_arguments.end(); ++it) {
+					it->element->share();
+					unbox(*it);
+				}
+				for_stack.clear();
+				lent_arguments.clear();
 				
 				std::stack<parsing::function_prototype*> toprint;
 				//cleanup
-				while (call_stack.size() > 1)
+				while (call_stack.back().prototype != nullptr)
 				{
-					toprint.push(call_stack.top()->prototype);
-					delete call_stack.top();
-					call_stack.pop();
+					toprint.push(call_stack.back().prototype);
+					frame_stack->pop_frame(call_stack.back().base);
+					call_stack.pop_back();
 				}
+				if (!nested)
+					frame_stack->pop_frame(0);
 
 				print_call_stack(toprint);
 				handle_runtime_err(runtime_error, err_tok);
+				error_located = false;
 				
-				ret_val = nullptr;
 				err = true;
 			}
+			register_top = result;
+
+			if (nested)
+				call_stack.pop_back();
 
 			if(multi_sweep)
-				garbage_collector.sweep(false);
+				collect_garbage();
 
+			delete code;
 			for (auto it = to_execute.begin(); it != to_execute.end(); ++it)
 				if(!tok_internalized(*it))
 					delete* it;
 
 			if (err)
 				return -abs(last_error);
-			if (ret_val == nullptr)
-				return 0;
-			long double exit_code = *ret_val->get_value()->get_numerical();
-			delete ret_val;
 			return exit_code;
 		}
 
 		void interpreter::include(const char* file_path) {
+			if (image_files.count(file_path))
+				return;
 			unsigned long path_hash = insecure_hash(file_path);
 			if (included_files.count(path_hash)) {
 				return;
 			}
 			included_files.insert(path_hash);
 
-			std::ifstream infile(file_path, std::ifstream::binary);
+			parsing::mapped_file infile(file_path);
 			if (!infile.is_open()) {
 				included_files.erase(path_hash);
 				throw ERROR_CANNOT_INCLUDE_FILE;
 			}
-			infile.seekg(0, std::ios::end);
-			int buffer_length = infile.tellg();
-			infile.seekg(0, std::ios::beg);
-			char* buffer = new char[buffer_length + 1];
-			infile.read(buffer, buffer_length);
-			infile.close();
-			buffer[buffer_length] = 0;
-			long rc = run(buffer, false);
-			delete[] buffer;
+			long rc = run_module(file_path, infile.get_data(), infile.get_length());
 			included_files.erase(path_hash);
 			if (rc != 0)
 				throw ERROR_CANNOT_INCLUDE_FILE;
+			included_paths.push_back(file_path);
 		}
 
-		void interpreter::set_ref(parsing::variable_access_token* access, reference_apartment* reference) {
-			if (access->modifiers.size() == 1) {
-				if (static_var_manager->has_var(access->get_identifier()))
-					static_var_manager->set_var_reference(access->get_identifier(), reference);
-				else if (call_stack.top()->manager->has_var(access->get_identifier()))
-					call_stack.top()->manager->set_var_reference(access->get_identifier(), reference);
-				else
-					throw ERROR_UNRECOGNIZED_VARIABLE;
+		long double interpreter::run_module(const char* file_path, const char* source, unsigned long source_length) {
+			std::string cache_path = std::string(file_path) + MODULE_CACHE_EXTENSION;
+			std::vector<parsing::token*> to_execute;
+			if (parsing::load_module(cache_path.c_str(), source, source_length, &lexer_state, to_execute))
+				return run_tokens(to_execute, source, source_length);
+
+			//files lexed within an unclosed group depend on it, so they aren't cached
+			bool cacheable = lexer_state.current_group() == nullptr;
+			struct parsing::lexer::lexer_state::constant_log log;
+			lexer_state.log = &log;
+			bool lexed = tokenize(source, source_length, false, to_execute);
+			lexer_state.log = nullptr;
+			if (!lexed)
+				return -1;
+			if (cacheable && lexer_state.current_group() == nullptr)
+				parsing::save_module(cache_path.c_str(), source, source_length, to_execute, &lexer_state, &log);
+			return run_tokens(to_execute, source, source_length);
+		}
+
+		//writes the variables declared in a manager as their symbol and root node
+		static void write_variables(parsing::module_writer* writer, heap_writer* heap, variable_manager* manager, parsing::symbol_table* symbols) {
+			unsigned int count = 0;
+			for (unsigned int slot = 0; slot < symbols->size(); slot++)
+				if (manager->has_var(slot))
+					count++;
+			writer->write_u32(count);
+			for (unsigned int slot = 0; slot < symbols->size(); slot++)
+				if (manager->has_var(slot)) {
+					writer->write_symbol(symbols->get_symbol(slot));
+					heap->write_root(manager->get_var_reference(slot));
+				}
+		}
+
+		static void read_variables(parsing::module_reader* reader, std::vector<std::pair<unsigned int, unsigned int>>& variables) {
+			unsigned int count = reader->read_u32();
+			for (unsigned int i = 0; i < count; i++) {
+				unsigned int symbol_id = reader->read_symbol();
+				variables.push_back(std::make_pair(symbol_id, reader->read_u32()));
 			}
-			else {
-				reference_apartment* current;
-				if (static_var_manager->has_var(access->get_identifier()))
-					current = static_var_manager->get_var_reference(access->get_identifier());
-				else if (call_stack.top()->manager->has_var(access->get_identifier()))
-					current = call_stack.top()->manager->get_var_reference(access->get_identifier());
-				else
-					throw ERROR_UNRECOGNIZED_VARIABLE;
-				for (auto i = ++access->modifiers.begin(); i != access->modifiers.end(); ++i) {
-					if (i == --access->modifiers.end()) {
-						if ((*i)->type == TOKEN_IDENTIFIER) {
-							parsing::identifier_token* prop = (parsing::identifier_token*)(*i);
-							if (current->value->type != VALUE_TYPE_STRUCT)
-								throw ERROR_MUST_HAVE_STRUCT_TYPE;
-							structure* parent = (structure*)current->value->ptr;
-							parent->set_reference(prop, reference);
-						}
-						else if ((*i)->type == TOKEN_INDEX) {
-							parsing::index_token* index = (parsing::index_token*)(*i);
-							if (current->value->type != VALUE_TYPE_COLLECTION)
-								throw ERROR_MUST_HAVE_COLLECTION_TYPE;
-							collection* parent = (collection*)current->value->ptr;
-							value_eval* index_eval = evaluate(index->value, false);
-							if (index_eval->get_value()->type != VALUE_TYPE_NUMERICAL)
-								throw ERROR_MUST_HAVE_NUM_TYPE;
-							unsigned long index_ul = (unsigned long)*(long double*)index_eval->get_value()->ptr;
-							parent->set_reference(index_ul, reference);
-							delete index_eval;
-						}
-					}
-					else {
-						if ((*i)->type == TOKEN_IDENTIFIER) {
-							parsing::identifier_token* prop = (parsing::identifier_token*)(*i);
-							if (current->value->type != VALUE_TYPE_STRUCT)
-								throw ERROR_MUST_HAVE_STRUCT_TYPE;
-							structure* parent = (structure*)current->value->ptr;
-							current = parent->get_reference(prop);
-						}
-						else if ((*i)->type == TOKEN_INDEX) {
-							parsing::index_token* index = (parsing::index_token*)(*i);
-							if (current->value->type != VALUE_TYPE_COLLECTION)
-								throw ERROR_MUST_HAVE_COLLECTION_TYPE;
-							collection* parent = (collection*)current->value->ptr;
-							value_eval* index_eval = evaluate(index->value, false);
-							if (index_eval->get_value()->type != VALUE_TYPE_NUMERICAL)
-								throw ERROR_MUST_HAVE_NUM_TYPE;
-							unsigned long index_ul = (unsigned long)*(long double*)index_eval->get_value()->ptr;
-							current = parent->get_reference(index_ul);
-							delete index_eval;
-						}
-					}
+		}
+
+		//frees a definition read from an image, tokens of any other kind are left alone
+		static void destroy_definition(parsing::token* tok) {
+			if (tok == nullptr)
+				return;
+			if (tok->type == TOKEN_STRUCT_PROTO)
+				delete (parsing::structure_prototype*)tok;
+			else if (tok->type == TOKEN_FUNC_PROTO)
+				delete (parsing::function_prototype*)tok;
+		}
+
+		bool interpreter::save_image(const char* path) {
+			parsing::module_writer body;
+			try {
+				body.write_u32((unsigned int)included_paths.size());
+				for (auto it = included_paths.begin(); it != included_paths.end(); ++it)
+					body.write_string(it->c_str(), (unsigned long)it->size());
+
+				body.write_u32((unsigned int)lexer_state.constants.size());
+				for (auto it = lexer_state.constants.begin(); it != lexer_state.constants.end(); ++it) {
+					value constant = it->second->copy_value();
+					body.write_symbol(it->first);
+					body.write_value(&constant);
 				}
+
+				std::vector<parsing::structure_prototype*> structs;
+				for (auto it = struct_definitions.begin(); it != struct_definitions.end(); ++it)
+					if (*it != nullptr)
+						structs.push_back(*it);
+				body.write_tokens(structs);
+
+				std::vector<parsing::function_prototype*> procs;
+				for (auto it = function_definitions.begin(); it != function_definitions.end(); ++it)
+					if (*it != nullptr)
+						procs.push_back(*it);
+				body.write_tokens(procs);
+
+				static_var_manager->expand(global_symbols.size());
+				global_var_manager->expand(global_symbols.size());
+				heap_writer heap(&body);
+				write_variables(&body, &heap, static_var_manager, &global_symbols);
+				write_variables(&body, &heap, global_var_manager, &global_symbols);
+				heap.write_nodes();
+			}
+			catch (int) {
+				return false;
 			}
+
+			parsing::module_writer header;
+			header.buffer.append(image_magic, sizeof(image_magic));
+			header.write_u8(IMAGE_FORMAT_VERSION);
+			header.write_u8(sizeof(long double));
+			header.write_symbol_table(body);
+			return parsing::write_file(path, header, body);
 		}
 
-		reference_apartment* interpreter::get_ref(parsing::variable_access_token* access) {
-			reference_apartment* current;
-			if (static_var_manager->has_var(access->get_identifier()))
-				current = static_var_manager->get_var_reference(access->get_identifier());
-			else if (call_stack.top()->manager->has_var(access->get_identifier()))
-				current = call_stack.top()->manager->get_var_reference(access->get_identifier());
-			else
-				throw ERROR_UNRECOGNIZED_VARIABLE;
-			for (auto i = ++access->modifiers.begin(); i != access->modifiers.end(); ++i)
-			{
-				if ((*i)->type == TOKEN_IDENTIFIER) {
-					parsing::identifier_token* prop = (parsing::identifier_token*)(*i);
-					if (current->value->type != VALUE_TYPE_STRUCT)
-						throw ERROR_MUST_HAVE_STRUCT_TYPE;
-					structure* parent = (structure*)current->value->ptr;
-					current = parent->get_reference(prop);
+		bool interpreter::load_image(const char* path) {
+			parsing::mapped_file image(path);
+			if (!image.is_open())
+				return false;
+
+			parsing::module_reader reader(image.get_data(), image.get_length());
+			heap_reader heap(&reader);
+			std::vector<std::string> paths;
+			std::vector<std::pair<unsigned int, value*>> constants;
+			std::vector<parsing::token*> structs;
+			std::vector<parsing::token*> procs;
+			std::vector<std::pair<unsigned int, unsigned int>> statics;
+			std::vector<std::pair<unsigned int, unsigned int>> globals;
+			try {
+				if (std::memcmp(reader.read_bytes(sizeof(image_magic)), image_magic, sizeof(image_magic)) != 0 ||
+					reader.read_u8() != IMAGE_FORMAT_VERSION ||
+					reader.read_u8() != sizeof(long double))
+					return false;
+
+				reader.read_symbol_table();
+
+				unsigned int path_count = reader.read_u32();
+				for (unsigned int i = 0; i < path_count; i++) {
+					unsigned int path_length = reader.read_u32();
+					paths.push_back(std::string(reader.read_bytes(path_length), path_length));
 				}
-				else if ((*i)->type == TOKEN_INDEX) {
-					parsing::index_token* index = (parsing::index_token*)(*i);
-					if (current->value->type != VALUE_TYPE_COLLECTION)
-						throw ERROR_MUST_HAVE_COLLECTION_TYPE;
-					collection* parent = (collection*)current->value->ptr;
-					value_eval* index_eval = evaluate(index->value, false);
-					if (index_eval->get_value()->type != VALUE_TYPE_NUMERICAL)
-						throw ERROR_MUST_HAVE_NUM_TYPE;
-					unsigned long index_ul = (unsigned long)*(long double*)index_eval->get_value()->ptr;
-					if (index_ul >= parent->size || index < 0)
-						throw ERROR_INDEX_OUT_OF_RANGE;
-					current = parent->get_reference(index_ul);
-					delete index_eval;
+
+				unsigned int constant_count = reader.read_u32();
+				for (unsigned int i = 0; i < constant_count; i++) {
+					unsigned int symbol_id = reader.read_symbol();
+					constants.push_back(std::make_pair(symbol_id, reader.read_value()));
+					if (constants.back().second == nullptr)
+						throw ERROR_INVALID_VALUE_TYPE;
+				}
+
+				structs = reader.read_tokens();
+				procs = reader.read_tokens();
+				for (auto it = structs.begin(); it != structs.end(); ++it)
+					if (*it == nullptr || (*it)->type != TOKEN_STRUCT_PROTO)
+						throw ERROR_UNEXPECTED_TOKEN;
+				for (auto it = procs.begin(); it != procs.end(); ++it)
+					if (*it == nullptr || (*it)->type != TOKEN_FUNC_PROTO)
+						throw ERROR_UNEXPECTED_TOKEN;
+
+				read_variables(&reader, statics);
+				read_variables(&reader, globals);
+				heap.read_nodes();
+				if (!reader.at_end())
+					throw ERROR_UNEXPECTED_TOKEN;
+				for (auto it = statics.begin(); it != statics.end(); ++it)
+					heap.check_root(it->second);
+				for (auto it = globals.begin(); it != globals.end(); ++it)
+					heap.check_root(it->second);
+
+				for (auto it = procs.begin(); it != procs.end(); ++it) {
+					parsing::function_prototype* proto = (parsing::function_prototype*)*it;
+					proto->compiled = new parsing::bytecode(proto, &global_symbols);
 				}
 			}
-			return current;
-		}
+			catch (int) {
+				//like a corrupted module, the tokens read before the corruption aren't freed
+				for (auto it = constants.begin(); it != constants.end(); ++it)
+					delete it->second;
+				for (auto it = structs.begin(); it != structs.end(); ++it)
+					destroy_definition(*it);
+				for (auto it = procs.begin(); it != procs.end(); ++it)
+					destroy_definition(*it);
+				return false;
+			}
 
-		interpreter::value_eval* interpreter::evaluate(parsing::token* eval_tok, bool force_reference) {
-			switch (eval_tok->type)
-			{
-			case TOKEN_VAR_ACCESS: {
-				parsing::variable_access_token* access = (parsing::variable_access_token*)eval_tok;
-				reference_apartment* ref = get_ref(access);
-				if (force_reference || !ref->value->is_primitive()) {
-					return new value_eval(ref);
+			//definitions the interpreter already has, such as imported structs, take precedence over the image's
+			std::vector<parsing::structure_prototype*> added_structs;
+			for (auto it = structs.begin(); it != structs.end(); ++it) {
+				parsing::structure_prototype* proto = (parsing::structure_prototype*)*it;
+				if (find_definition(struct_definitions, proto->identifier->symbol_id) != nullptr)
+					delete proto;
+				else {
+					add_definition(struct_definitions, proto->identifier->symbol_id, proto, ERROR_STRUCT_PROTO_ALREADY_DEFINED);
+					added_structs.push_back(proto);
+				}
+			}
+
+			try {
+				heap.build(struct_definitions, &garbage_collector);
+			}
+			catch (int) {
+				for (auto it = added_structs.begin(); it != added_structs.end(); ++it) {
+					struct_definitions[(*it)->identifier->symbol_id] = nullptr;
+					delete *it;
 				}
-				return new value_eval(ref->value->clone());
+				for (auto it = constants.begin(); it != constants.end(); ++it)
+					delete it->second;
+				for (auto it = procs.begin(); it != procs.end(); ++it)
+					delete (parsing::function_prototype*)*it;
+				return false;
+			}
+
+			for (auto it = constants.begin(); it != constants.end(); ++it)
+				lexer_state.define_constant(it->first, new parsing::value_token(it->second));
+
+			for (auto it = procs.begin(); it != procs.end(); ++it) {
+				parsing::function_prototype* proto = (parsing::function_prototype*)*it;
+				if (find_definition(function_definitions, proto->identifier->symbol_id) != nullptr || find_definition(built_in_functions, proto->identifier->symbol_id) != nullptr)
+					delete proto;
+				else
+					add_definition(function_definitions, proto->identifier->symbol_id, proto, ERROR_FUNCTION_PROTO_ALREADY_DEFINED);
 			}
-			case TOKEN_GET_REFERENCE: {
-				parsing::get_reference_token* get_ref_tok = (parsing::get_reference_token*)eval_tok;
-				return new value_eval(get_ref(get_ref_tok->var_access));
+			definition_generation++;
+
+			for (auto it = statics.begin(); it != statics.end(); ++it)
+				it->first = global_symbols.resolve(it->first);
+			for (auto it = globals.begin(); it != globals.end(); ++it)
+				it->first = global_symbols.resolve(it->first);
+			static_var_manager->expand(global_symbols.size());
+			global_var_manager->expand(global_symbols.size());
+			for (auto it = statics.begin(); it != statics.end(); ++it) {
+				if (static_var_manager->has_var(it->first))
+					static_var_manager->set_var_reference(it->first, heap.get_root(it->second));
+				else
+					static_var_manager->declare_var(it->first, heap.get_root(it->second));
 			}
-			case TOKEN_VALUE: {
-				parsing::value_token* val_tok = (parsing::value_token*)eval_tok;
-				return new value_eval(val_tok->get_value());
+			for (auto it = globals.begin(); it != globals.end(); ++it) {
+				if (global_var_manager->has_var(it->first))
+					global_var_manager->set_var_reference(it->first, heap.get_root(it->second));
+				else
+					global_var_manager->declare_var(it->first, heap.get_root(it->second));
 			}
-			case TOKEN_CREATE_STRUCT: {
-				parsing::create_struct_token* create_struct = (parsing::create_struct_token*)eval_tok;
-				if (!struct_definitions.count(create_struct->identifier->id_hash))
-					throw ERROR_STRUCT_PROTO_NOT_DEFINED;
-				structure* created_struct = new structure(struct_definitions[create_struct->identifier->id_hash], &garbage_collector);
-				return new value_eval(created_struct->get_parent_ref());
+
+			for (auto it = paths.begin(); it != paths.end(); ++it) {
+				included_paths.push_back(*it);
+				image_files.insert(*it);
 			}
-			case TOKEN_CREATE_ARRAY: {
-				parsing::create_array_token* create_array = (parsing::create_array_token*)eval_tok;
-				collection* col = new collection(create_array->values.size(), &garbage_collector);
-				unsigned int i = 0;
-				for (auto it = create_array->values.begin(); it != create_array->values.end(); ++it)
-				{
-					value_eval* item_eval = evaluate(*it, false);
-					if (item_eval->type == VALUE_EVAL_TYPE_REF)
-						col->set_reference(i++, item_eval->get_reference());
-					else {
-						item_eval->keep();
-						col->set_value(i++, item_eval->get_value());
+			return true;
+		}
+
+		void interpreter::collect_garbage() {
+			if (garbage_collector.begin_collection()) {
+				static_var_manager->mark();
+				global_var_manager->mark();
+				frame_stack->mark();
+				for (unsigned int i = 0; i < register_top; i++)
+					if (registers[i].reference != nullptr)
+						garbage_collector.mark(registers[i].reference);
+				for (auto it = for_stack.begin(); it != for_stack.end(); ++it)
+					if (it->kind == FOR_ITERATE_COLLECTION) {
+						garbage_collector.mark(it->reference);
+						if (it->lent.element != nullptr)
+							garbage_collector.mark(it->lent.element);
 					}
-					delete item_eval;
+				for (auto it = lent_arguments.begin(); it != lent_arguments.end(); ++it) {
+					garbage_collector.mark(it->lender);
+					garbage_collector.mark(it->element);
 				}
-				return new value_eval(col->get_parent_ref());
 			}
-			case TOKEN_SET: {
-				parsing::set_token* set_tok = (parsing::set_token*)eval_tok;
-				value_eval* eval = evaluate(set_tok->value, false);
-				if (set_tok->destination->modifiers.size() == 1) {
-					if (set_tok->create_static) {
-						if (static_var_manager->has_var(set_tok->destination->get_identifier()))
-							throw ERROR_UNEXPECTED_TOKEN;
-						if (eval->type == VALUE_EVAL_TYPE_REF)
-							static_var_manager->declare_var(set_tok->destination->get_identifier(), eval->get_reference());
-						else {
-							eval->keep();
-							static_var_manager->declare_var(set_tok->destination->get_identifier(), eval->get_value());
+			garbage_collector.sweep();
+		}
+
+		//bounds checks an index into a collection
+		static inline unsigned long get_index(value* parent, value* index) {
+			if (parent->type != VALUE_TYPE_COLLECTION)
+				throw ERROR_MUST_HAVE_COLLECTION_TYPE;
+			if (index->type != VALUE_TYPE_NUMERICAL)
+				throw ERROR_MUST_HAVE_NUM_TYPE;
+			unsigned long index_ul = (unsigned long)*index->get_numerical();
+			if (index_ul >= ((collection*)parent->ptr)->size)
+				throw ERROR_INDEX_OUT_OF_RANGE;
+			return index_ul;
+		}
+
+		static inline structure* get_struct(value* parent) {
+			if (parent->type != VALUE_TYPE_STRUCT)
+				throw ERROR_MUST_HAVE_STRUCT_TYPE;
+			return (structure*)parent->ptr;
+		}
+
+		//applies the common operators to two numericals, returns false if the operator isn't one of them
+		static inline bool inline_binary_op(unsigned char op, long double a, long double b, long double* result) {
+			switch (op)
+			{
+			case OP_ADD:
+				*result = a + b;
+				return true;
+			case OP_SUBTRACT:
+				*result = a - b;
+				return true;
+			case OP_MULTIPLY:
+				*result = a * b;
+				return true;
+			case OP_EQUALS:
+				*result = !(a < b) && !(a > b);
+				return true;
+			case OP_NOT_EQUAL:
+				*result = (a < b) || (a > b);
+				return true;
+			case OP_LESS:
+				*result = a < b;
+				return true;
+			case OP_MORE:
+				*result = a > b;
+				return true;
+			case OP_LESS_EQUAL:
+				*result = !(a > b);
+				return true;
+			case OP_MORE_EQUAL:
+				*result = !(a < b);
+				return true;
+			default:
+				return false;
+			}
+		}
+
+		//whether a load instruction references it's value, an argument's mode depends on what it's call resolved to
+		static inline bool by_reference(const parsing::instruction* ins, const parsing::instruction* begin) {
+			if (ins->op == LOAD_MODE_ARGUMENT)
+				return ((parsing::function_call_token*)begin[ins->c].tok)->resolved_prototype != nullptr;
+			return ins->op != LOAD_MODE_VALUE;
+		}
+
+		reference_apartment* interpreter::lend(lent_element& lent, collection* lender, unsigned long index) {
+			lent.lender = lender->get_parent_ref();
+			lent.index = index;
+			lent.element = lender->lend(index);
+			return lent.element;
+		}
+
+		void interpreter::unbox(lent_element& lent) {
+			value* lender = lent.lender->value;
+			if (lender->type == VALUE_TYPE_COLLECTION)
+				((collection*)lender->ptr)->unbox(lent.index, lent.element);
+			lent.element = nullptr;
+		}
+
+		void interpreter::call(parsing::function_call_token* func_call, unsigned int result) {
+			unsigned int argument_count = (unsigned int)func_call->arguments.size();
+			if (func_call->resolved_prototype != nullptr) {
+				parsing::function_prototype* to_execute = func_call->resolved_prototype;
+				unsigned int new_base = frame_stack->push_frame(to_execute->compiled->get_frame_size());
+				value_register* arguments = registers.data() + result + 1;
+				if (to_execute->params_mode) {
+					collection* param_args = new collection(argument_count, &garbage_collector);
+					for (unsigned int i = 0; i < argument_count; i++) {
+						if (arguments[i].reference != nullptr) {
+							arguments[i].reference->share();
+							param_args->set_reference(i, arguments[i].reference);
 						}
+						else
+							param_args->set_primitive(i, &arguments[i].val);
 					}
-					else {
-						if (call_stack.top()->manager->has_var(set_tok->destination->get_identifier())) {
-							if (eval->type == VALUE_EVAL_TYPE_REF)
-								call_stack.top()->manager->set_var_reference(set_tok->destination->get_identifier(), eval->get_reference());
-							else {
-								eval->keep();
-								call_stack.top()->manager->set_var_value(set_tok->destination->get_identifier(), eval->get_value());
-							}
-						}
-						else if (static_var_manager->has_var(set_tok->destination->get_identifier())) {
-							if (eval->type == VALUE_EVAL_TYPE_REF)
-								static_var_manager->set_var_reference(set_tok->destination->get_identifier(), eval->get_reference());
-							else {
-								eval->keep();
-								static_var_manager->set_var_value(set_tok->destination->get_identifier(), eval->get_value());
-							}
-						}
-						else {
-							if (eval->type == VALUE_EVAL_TYPE_REF) {
-								call_stack.top()->manager->declare_var(set_tok->destination->get_identifier(), eval->get_reference());
-							}
-							else {
-								eval->keep();
-								call_stack.top()->manager->declare_var(set_tok->destination->get_identifier(), eval->get_value());
-							}
-						}
-					}          
+					frame_stack->declare_var(new_base + to_execute->argument_identifiers.front()->slot, param_args->get_parent_ref());
 				}
 				else {
-					if (eval->type == VALUE_EVAL_TYPE_REF) {
-						set_ref(set_tok->destination, eval->get_reference());
+					for (unsigned int i = 0; i < argument_count; i++) {
+						if (arguments[i].reference != nullptr)
+							frame_stack->declare_var(new_base + to_execute->argument_identifiers[i]->slot, arguments[i].reference);
+						else
+							frame_stack->declare_var(new_base + to_execute->argument_identifiers[i]->slot, arguments[i].release());
 					}
-					else {
-						eval->keep();
-						set_val(set_tok->destination, eval->get_value());
-					}
-				}
-				if (eval->type == VALUE_EVAL_TYPE_VAL) {
-					value* eval_clone = eval->get_value()->clone();
-					delete eval;
-					return new value_eval(eval_clone);
 				}
-				else {
-					return eval;
-				}
-			}
-			case TOKEN_BINARY_OP: {
-				parsing::binary_operator_token* binop = (parsing::binary_operator_token*)eval_tok;
-				value_eval* a_eval = evaluate(binop->left, false);
-				if (binop->type == OP_AND) {
-					if (*a_eval->get_value()->get_numerical() == 0) {
-						delete a_eval;
-						return new value_eval(new value(VALUE_TYPE_NUMERICAL, new long double(1)));
-					}
-					else {
-						delete a_eval;
-						return new value_eval(new value(VALUE_TYPE_NUMERICAL, new long double(0)));
+				call_stack.push_back(call_frame(to_execute, frame_stack, new_base));
+				execute(to_execute->compiled, result);
+				call_stack.pop_back();
+				frame_stack->pop_frame(new_base);
+
+				//the call's own lent arguments are the most recent, since any lent by calls within it's arguments have been unboxed
+				arguments = registers.data() + result + 1;
+				for (unsigned int i = argument_count; i > 0 && !lent_arguments.empty(); i--)
+					if (lent_arguments.back().element == arguments[i - 1].reference) {
+						unbox(lent_arguments.back());
+						lent_arguments.pop_back();
 					}
-				}
-				else if (binop->type == OP_OR) {
-					if (*a_eval->get_value()->get_numerical() != 0)
-						delete a_eval;
-					return new value_eval(new value(VALUE_TYPE_NUMERICAL, new long double(1)));
-				}
-				value_eval* b_eval = evaluate(binop->right, false);
-				value_eval* result;
-				if (a_eval->get_value()->type == VALUE_TYPE_COLLECTION && b_eval->get_value()->type == VALUE_TYPE_COLLECTION && binop->op == OP_ADD) {
-					reference_apartment* appartment = garbage_collector.new_apartment(nullptr);
-					collection* c = new collection((collection*)a_eval->get_value()->ptr, (collection*)b_eval->get_value()->ptr, appartment);
-					appartment->value = new value(VALUE_TYPE_COLLECTION, c);
-					return new value_eval(appartment);
-				}
-				else {
-					result = new value_eval(evaluate_binary_op(binop->op, a_eval->get_value(), b_eval->get_value()));
-				}
-				delete a_eval;
-				delete b_eval;
-				return result;
+				safe_point(); //the returned value is held by the result register
 			}
-			case TOKEN_UNARY_OP: {
-				parsing::unary_operator_token* uniop = (parsing::unary_operator_token*)eval_tok;
-				value_eval* a_eval = evaluate(uniop->value, true);
-				value_eval* result = new value_eval(evaluate_unary_op(uniop->op, a_eval->get_value()));
-				delete a_eval;
-				return result;
+			else {
+				std::vector<value*> arguments;
+				arguments.reserve(argument_count);
+				for (unsigned int i = 0; i < argument_count; i++)
+					arguments.push_back(registers[result + 1 + i].get_value());
+				registers[result].set_reference(func_call->resolved_built_in(arguments, &garbage_collector));
 			}
-			case TOKEN_FUNCTION_CALL: {
-				parsing::token* old_err_tok = err_tok;
-				parsing::function_call_token* func_call = (parsing::function_call_token*)eval_tok;
-				if (function_definitions.count(func_call->identifier->id_hash)) {
-					parsing::function_prototype* to_execute = function_definitions[func_call->identifier->id_hash];
-					call_frame* new_frame = new call_frame(to_execute, &garbage_collector);
-					if (to_execute->params_mode) {
-						unsigned int i = 0;
-						collection* param_args = new collection(func_call->arguments.size(), &garbage_collector);
-						for (auto arg_val_it = func_call->arguments.begin(); arg_val_it != func_call->arguments.end(); ++arg_val_it) {
-							value_eval* arg_eval = evaluate(*arg_val_it, true);
-							if (arg_eval->type == VALUE_EVAL_TYPE_REF)
-								param_args->set_reference(i++, arg_eval->get_reference());
-							else {
-								arg_eval->keep();
-								param_args->set_value(i++, arg_eval->get_value());
-							}
-							delete arg_eval;
-						}
-						new_frame->manager->declare_var(to_execute->argument_identifiers.front()->id_hash, param_args->get_parent_ref());
+		}
+
+		void interpreter::execute(parsing::bytecode* code, unsigned int result) {
+			size_t for_base = for_stack.size();
+			unsigned int register_base = register_top;
+			register_top += code->get_register_count();
+			if (registers.size() < register_top)
+				registers.resize(register_top);
+			value_register* regs = registers.data() + register_base;
+
+			variable_manager* locals = call_stack.back().locals;
+			unsigned int frame_base = call_stack.back().base;
+
+			const parsing::instruction* begin = code->begin();
+			const parsing::instruction* end = code->end();
+			const parsing::instruction* ip = begin;
+			try {
+				while (ip != end) {
+					switch (ip->opcode)
+					{
+					case OPCODE_LOAD_CONST:
+						regs[ip->a].set_primitive(((parsing::value_token*)ip->tok)->peek_value());
+						break;
+					case OPCODE_LOAD_VAR:
+						//an operand is only referenced while it's operator modifies it, so a lent element can still be unboxed
+						if (ip->op == LOAD_MODE_OPERAND)
+							regs[ip->a].set_reference(get_var_ref((parsing::identifier_token*)ip->tok));
+						else
+							load(regs[ip->a], get_var_ref((parsing::identifier_token*)ip->tok), by_reference(ip, begin));
+						break;
+					case OPCODE_LOAD_PROPERTY: {
+						structure* parent = get_struct(regs[ip->a].get_value());
+						load(regs[ip->a], parent->get_reference((parsing::identifier_token*)ip->tok), by_reference(ip, begin));
+						break;
 					}
-					else {
-						if (func_call->arguments.size() != to_execute->argument_identifiers.size())
-							throw ERROR_UNEXPECTED_ARGUMENT_SIZE;
-						auto arg_id_it = to_execute->argument_identifiers.begin();
-						for (auto arg_val_it = func_call->arguments.begin(); arg_val_it != func_call->arguments.end(); ++arg_val_it) {
-							value_eval* arg_eval = evaluate(*arg_val_it, true);
-							if (arg_eval->type == VALUE_EVAL_TYPE_REF)
-								new_frame->manager->declare_var(*arg_id_it, arg_eval->get_reference());
-							else {
-								arg_eval->keep();
-								new_frame->manager->declare_var(*arg_id_it, arg_eval->get_value());
-							}
-							delete arg_eval;
-							arg_id_it++;
+					case OPCODE_LOAD_INDEX: {
+						value* parent = regs[ip->a].get_value();
+						unsigned long index = get_index(parent, regs[ip->b].get_value());
+						collection* col = (collection*)parent->ptr;
+						bool reference = by_reference(ip, begin);
+
+						//packed elements are read in place, and boxed on their own while they're lent to a procedure
+						if (!reference && col->is_element_packed(index))
+							regs[ip->a].set_value(col->get_packed(index));
+						else if (ip->op == LOAD_MODE_ARGUMENT && col->is_element_packed(index)) {
+							lent_arguments.emplace_back();
+							regs[ip->a].set_reference(lend(lent_arguments.back(), col, index));
 						}
+						else if (!reference && col->get_value(index)->is_primitive())
+							regs[ip->a].set_primitive(col->get_value(index));
+						else
+							load(regs[ip->a], col->get_reference(index), reference);
+						break;
 					}
-					call_stack.push(new_frame);
-					value_eval* ret_val = execute_block(to_execute->tokens);
-					err_tok = old_err_tok;
-					if (ret_val == nullptr) {
-						if (break_mode)
-							throw ERROR_UNEXPECTED_BREAK;
-						ret_val = new value_eval(new value(VALUE_TYPE_NULL, nullptr));
+					case OPCODE_STORE_VAR: {
+						parsing::identifier_token* identifier = (parsing::identifier_token*)ip->tok;
+						value_register& source = regs[ip->a];
+						if (ip->op) {
+							if (static_var_manager->has_var(identifier->static_slot))
+								throw ERROR_UNEXPECTED_TOKEN;
+							if (source.reference != nullptr)
+								static_var_manager->declare_var(identifier->static_slot, source.reference);
+							else
+								static_var_manager->declare_var(identifier->static_slot, source.val.clone());
+						}
+						else if (locals->has_var(frame_base + identifier->slot)) {
+							if (source.reference != nullptr)
+								locals->set_var_reference(frame_base + identifier->slot, source.reference);
+							else
+								locals->get_var_reference(frame_base + identifier->slot)->set_primitive(&source.val);
+						}
+						else if (static_var_manager->has_var(identifier->static_slot)) {
+							if (source.reference != nullptr)
+								static_var_manager->set_var_reference(identifier->static_slot, source.reference);
+							else
+								static_var_manager->get_var_reference(identifier->static_slot)->set_primitive(&source.val);
+						}
+						else {
+							if (source.reference != nullptr)
+								locals->declare_var(frame_base + identifier->slot, source.reference);
+							else
+								locals->declare_var(frame_base + identifier->slot, source.val.clone());
+						}
+						break;
 					}
-					if (ret_val->type == VALUE_EVAL_TYPE_REF)
-						ret_val->get_reference()->add_reference(); //add and incrememnt before garbage collection to preserve defer a references deletion to the callee call frame for further use
-					delete call_stack.top();
-					call_stack.pop();
-					if (ret_val->type == VALUE_EVAL_TYPE_REF)
-						ret_val->get_reference()->remove_reference();
-					return ret_val;
-				}
-				else if (built_in_functions.count(func_call->identifier->id_hash)) {
-					std::vector<value*> arguments;
-					std::list<bool> can_delete;
-					for (auto it = func_call->arguments.begin(); it != func_call->arguments.end(); ++it) {
-						value_eval* arg_eval = evaluate(*it, false);
-						arguments.push_back(arg_eval->get_value());
-						can_delete.push_back(arg_eval->type != VALUE_EVAL_TYPE_REF);
-						if (arg_eval->type == VALUE_EVAL_TYPE_VAL)
-							arg_eval->keep();
-						delete arg_eval;
+					case OPCODE_STORE_PROPERTY: {
+						structure* parent = get_struct(regs[ip->b].get_value());
+						value_register& source = regs[ip->a];
+						if (source.reference != nullptr)
+							parent->set_reference((parsing::identifier_token*)ip->tok, source.reference);
+						else
+							parent->get_reference((parsing::identifier_token*)ip->tok)->set_primitive(&source.val);
+						break;
 					}
-					reference_apartment* val = built_in_functions[func_call->identifier->id_hash](arguments, &garbage_collector);
-					auto del = can_delete.begin();
-					for (auto it = arguments.begin(); it != arguments.end(); ++it) {
-						if (*del)
-							delete* it;
-						++del;
+					case OPCODE_STORE_INDEX: {
+						value* parent = regs[ip->b].get_value();
+						unsigned long index = get_index(parent, regs[ip->c].get_value());
+						value_register& source = regs[ip->a];
+
+						//elements of packed collections are set in place, without boxing the collection
+						if (source.reference != nullptr)
+							((collection*)parent->ptr)->set_reference(index, source.reference);
+						else
+							((collection*)parent->ptr)->set_primitive(index, &source.val);
+						break;
 					}
-					return new value_eval(val);
-				}
-				throw ERROR_FUNCTION_PROTO_NOT_DEFINED;
-			}
-			}
-			throw ERROR_UNEXPECTED_TOKEN;
-		}
+					case OPCODE_BINARY_OP: {
+						value* a = regs[ip->b].get_value();
+						value* b = regs[ip->c].get_value();
 
-		interpreter::value_eval* interpreter::execute_block(std::list<parsing::token*> tokens) {
-			for (auto it = tokens.begin(); it != tokens.end(); ++it) {
-				err_tok = *it;
-				switch ((*it)->type)
-				{
-				case TOKEN_BREAK:
-					this->break_mode = true;
-					break;
-				case TOKEN_INCLUDE: {
-					parsing::include_token* include_tok = (parsing::include_token*)*it;
-					include(include_tok->get_file_path());
-					break;
-				}
-				case TOKEN_IF:
-				case TOKEN_WHILE: {
-					parsing::conditional_token* current = (parsing::conditional_token*)*it;
-					while (current != nullptr) {
-						err_tok = current;
-						if (current->condition == nullptr) {
-							value_eval* eval = execute_block(current->instructions);
-							if (eval != nullptr) {
-								if (break_mode)
-									return nullptr;
-								return eval;
-							}
+						//arithmetic and comparisons between numericals are done inline
+						long double numerical;
+						if (a->type == VALUE_TYPE_NUMERICAL && b->type == VALUE_TYPE_NUMERICAL && inline_binary_op(ip->op, *a->get_numerical(), *b->get_numerical(), &numerical)) {
+							regs[ip->a].set_numerical(numerical);
 							break;
 						}
-						value_eval* cond_eval = evaluate(current->condition, false);
-						if (*cond_eval->get_value()->get_numerical() == 0)
-							current = current->get_next_conditional(false);
-						else {
-							value_eval* ret_eval = execute_block(current->instructions);
-							if (ret_eval != nullptr) {
-								delete cond_eval;
-								return ret_eval;
+						else if (a->type == VALUE_TYPE_COLLECTION && b->type == VALUE_TYPE_COLLECTION && ip->op == OP_ADD) {
+							reference_apartment* appartment = garbage_collector.new_apartment(nullptr);
+							collection* c = new collection((collection*)a->ptr, (collection*)b->ptr, appartment);
+							appartment->value = new value(VALUE_TYPE_COLLECTION, c);
+							regs[ip->a].set_reference(appartment);
+							break;
+						}
+						regs[ip->a].set_value(evaluate_binary_op(ip->op, a, b));
+						break;
+					}
+					case OPCODE_UNARY_OP: {
+						value* operand = regs[ip->a].get_value();
+						if (operand->type == VALUE_TYPE_NUMERICAL && (ip->op == OP_INCRIMENT || ip->op == OP_DECRIMENT)) {
+							long double old = *operand->get_numerical();
+							*operand->get_numerical() = ip->op == OP_INCRIMENT ? old + 1 : old - 1;
+							regs[ip->a].set_numerical(old);
+						}
+						else
+							regs[ip->a].set_value(evaluate_unary_op(ip->op, operand));
+						break;
+					}
+					case OPCODE_UNARY_INDEX: {
+						value* parent = regs[ip->b].get_value();
+						unsigned long index = get_index(parent, regs[ip->c].get_value());
+						collection* col = (collection*)parent->ptr;
+
+						//a packed element is operated on as a copy, which is written back if the operator modified it
+						if (col->is_element_packed(index)) {
+							value element = col->get_packed(index);
+							regs[ip->a].set_value(evaluate_unary_op(ip->op, &element));
+							if (ip->op == OP_INCRIMENT || ip->op == OP_DECRIMENT)
+								col->set_primitive(index, &element);
+						}
+						else
+							regs[ip->a].set_value(evaluate_unary_op(ip->op, col->get_value(index)));
+						break;
+					}
+					case OPCODE_NEW_STRUCT: {
+						parsing::create_struct_token* create_struct = (parsing::create_struct_token*)ip->tok;
+						parsing::structure_prototype* proto = find_definition(struct_definitions, create_struct->identifier->symbol_id);
+						if (proto == nullptr)
+							throw ERROR_STRUCT_PROTO_NOT_DEFINED;
+						regs[ip->a].set_reference((new structure(proto, &garbage_collector))->get_parent_ref());
+						break;
+					}
+					case OPCODE_NEW_STRING: {
+						parsing::create_array_token* create_array = (parsing::create_array_token*)ip->tok;
+						regs[ip->a].set_reference((new collection(create_array->string, create_array->string_length, &garbage_collector))->get_parent_ref());
+						break;
+					}
+					case OPCODE_NEW_ARRAY:
+						regs[ip->a].set_reference((new collection(ip->b, &garbage_collector))->get_parent_ref());
+						break;
+					case OPCODE_ARRAY_SET: {
+						collection* col = (collection*)regs[ip->a].get_value()->ptr;
+						if (regs[ip->c].reference != nullptr)
+							col->set_reference(ip->b, regs[ip->c].reference);
+						else
+							col->set_primitive(ip->b, &regs[ip->c].val);
+						break;
+					}
+					case OPCODE_CALL_RESOLVE: {
+						parsing::function_call_token* func_call = (parsing::function_call_token*)ip->tok;
+						if (func_call->resolved_generation != definition_generation)
+							resolve_call(func_call);
+						if (func_call->resolved_prototype != nullptr) {
+							if (!func_call->resolved_prototype->params_mode && func_call->arguments.size() != func_call->resolved_prototype->argument_identifiers.size())
+								throw ERROR_UNEXPECTED_ARGUMENT_SIZE;
+						}
+						else if (func_call->resolved_built_in == nullptr)
+							throw ERROR_FUNCTION_PROTO_NOT_DEFINED;
+						break;
+					}
+					case OPCODE_CALL:
+						call((parsing::function_call_token*)ip->tok, register_base + ip->a);
+						regs = registers.data() + register_base;
+						break;
+					case OPCODE_RETURN: {
+						value_register& returned = regs[ip->a];
+						if (returned.reference != nullptr)
+							registers[result].set_reference(returned.reference);
+						else
+							registers[result].set_primitive(&returned.val);
+						while (for_stack.size() > for_base) {
+							if (for_stack.back().lent.element != nullptr)
+								unbox(for_stack.back().lent);
+							for_stack.pop_back();
+						}
+						register_top = register_base;
+						return;
+					}
+					case OPCODE_JUMP:
+						ip = begin + ip->a;
+						continue;
+					case OPCODE_JUMP_IF_FALSE:
+						if (*regs[ip->b].get_value()->get_numerical() == 0) {
+							ip = begin + ip->a;
+							continue;
+						}
+						break;
+					case OPCODE_LOOP:
+						safe_point();
+						ip = begin + ip->a;
+						continue;
+					case OPCODE_FOR_BEGIN: {
+						parsing::for_token* for_tok = (parsing::for_token*)ip->tok;
+						for_iterator iterator;
+						iterator.index = 0;
+						iterator.kind = FOR_ITERATE_COLLECTION;
+						if (ip->op) {
+							//a call to range is streamed without materializing it, any other call is made
+							parsing::function_call_token* func_call = (parsing::function_call_token*)for_tok->collection;
+							if (func_call->resolved_prototype == nullptr && func_call->resolved_built_in == builtins::get_range) {
+								std::vector<value*> arguments;
+								arguments.reserve(ip->b);
+								for (unsigned int i = 0; i < ip->b; i++)
+									arguments.push_back(regs[ip->a + 1 + i].get_value());
+								long double stop;
+								builtins::get_range_bounds(arguments, &iterator.start, &stop, &iterator.step);
+								iterator.size = builtins::get_range_size(iterator.start, stop, iterator.step);
+								iterator.kind = FOR_ITERATE_RANGE;
+								iterator.reference = nullptr;
+								iterator.to_iterate = nullptr;
 							}
-							else if (break_mode) {
-								delete cond_eval;
-								if (current->type == TOKEN_WHILE) {
-									break_mode = false;
-									break;
-								}
-								return nullptr;
+							else {
+								call(func_call, register_base + ip->a);
+								regs = registers.data() + register_base;
 							}
-							current = current->get_next_conditional(true);
 						}
-						if(multi_sweep)
-							garbage_collector.sweep(false);
-						delete cond_eval;
+						if (iterator.kind == FOR_ITERATE_COLLECTION) {
+							value* to_iterate = regs[ip->a].get_value();
+							if (to_iterate->type != VALUE_TYPE_COLLECTION)
+								throw ERROR_MUST_HAVE_COLLECTION_TYPE;
+							iterator.to_iterate = (collection*)to_iterate->ptr;
+							iterator.reference = iterator.to_iterate->get_parent_ref();
+						}
+
+						if (!locals->has_var(frame_base + for_tok->identifier->slot))
+							locals->declare_var(frame_base + for_tok->identifier->slot, new value(VALUE_TYPE_NULL, nullptr));
+						for_stack.push_back(std::move(iterator));
+						break;
 					}
-					break;
-				}
-				case TOKEN_FOR: {
-					parsing::for_token* for_tok = (parsing::for_token*)*it;
-					value_eval* to_iterate_eval = evaluate(for_tok->collection, true);
-					if (to_iterate_eval->get_value()->type != VALUE_TYPE_COLLECTION)
-						throw ERROR_MUST_HAVE_COLLECTION_TYPE;
-					collection* to_iterate = (collection*)to_iterate_eval->get_value()->ptr;
-					delete to_iterate_eval;
-
-					if(!call_stack.top()->manager->has_var(for_tok->identifier))
-						call_stack.top()->manager->declare_var(for_tok->identifier, new value(VALUE_TYPE_NULL, nullptr));
-					
-					for (unsigned int i = 0; i < to_iterate->size; i++)
-					{
-						call_stack.top()->manager->set_var_reference(for_tok->identifier, to_iterate->get_reference(i));
-						value_eval* eval = execute_block(for_tok->instructions);
-						if (eval != nullptr) {
-							return eval;
+					case OPCODE_FOR_NEXT: {
+						parsing::for_token* for_tok = (parsing::for_token*)ip->tok;
+						for_iterator& iterator = for_stack.back();
+						if (iterator.kind == FOR_ITERATE_RANGE) {
+							if (iterator.index >= iterator.size) {
+								ip = begin + ip->a;
+								continue;
+							}
+							long double number = iterator.start + iterator.index++ * iterator.step;
+							locals->set_var_reference(frame_base + for_tok->identifier->slot, garbage_collector.new_apartment(new value(number)));
+							break;
 						}
-						else if (break_mode) {
-							break_mode = false;
-							return nullptr;
+						if (iterator.lent.element != nullptr)
+							unbox(iterator.lent);
+						if (iterator.index >= iterator.to_iterate->size) {
+							ip = begin + ip->a;
+							continue;
 						}
+
+						//each element is lent to the loop variable, so a packed element is only boxed until the loop moves on
+						locals->set_var_reference(frame_base + for_tok->identifier->slot, lend(iterator.lent, iterator.to_iterate, iterator.index++));
+						break;
 					}
-					call_stack.top()->manager->remove_var(for_tok->identifier);
-					break;
-				}
-				case TOKEN_UNARY_OP:
-				case TOKEN_FUNCTION_CALL:
-				case TOKEN_SET:
-					delete evaluate(*it, false);
-					break;
-				case TOKEN_RETURN: {
-					parsing::return_token* ret_tok = (parsing::return_token*)*it;
-					return evaluate(ret_tok->value, false);
-				}
-				case TOKEN_FUNC_PROTO: {
-					parsing::function_prototype* proto = (parsing::function_prototype*)*it;
-					if (function_definitions.count(proto->identifier->id_hash))
-						throw ERROR_FUNCTION_PROTO_ALREADY_DEFINED;
-					function_definitions[proto->identifier->id_hash] = proto;
-					break;
-				}
-				case TOKEN_STRUCT_PROTO: {
-					parsing::structure_prototype* proto = (parsing::structure_prototype*)*it;
-					if (struct_definitions.count(proto->identifier->id_hash))
-						throw ERROR_STRUCT_PROTO_ALREADY_DEFINED;
-					struct_definitions[proto->identifier->id_hash] = proto;
-					break;
+					case OPCODE_FOR_END:
+						if (for_stack.back().lent.element != nullptr)
+							unbox(for_stack.back().lent);
+						for_stack.pop_back();
+						locals->remove_var(frame_base + ((parsing::for_token*)ip->tok)->identifier->slot);
+						break;
+					case OPCODE_UNEXPECTED_BREAK:
+						throw ERROR_UNEXPECTED_BREAK;
+					case OPCODE_UNEXPECTED_TOKEN:
+						throw ERROR_UNEXPECTED_TOKEN;
+					case OPCODE_INCLUDE:
+						include(((parsing::include_token*)ip->tok)->get_file_path());
+						regs = registers.data() + register_base;
+						break;
+					case OPCODE_DEFINE_PROC: {
+						parsing::function_prototype* proto = (parsing::function_prototype*)ip->tok;
+						add_definition(function_definitions, proto->identifier->symbol_id, proto, ERROR_FUNCTION_PROTO_ALREADY_DEFINED);
+						definition_generation++;
+						break;
+					}
+					case OPCODE_DEFINE_STRUCT: {
+						parsing::structure_prototype* proto = (parsing::structure_prototype*)ip->tok;
+						add_definition(struct_definitions, proto->identifier->symbol_id, proto, ERROR_STRUCT_PROTO_ALREADY_DEFINED);
+						break;
+					}
+					default:
+						throw ERROR_UNEXPECTED_TOKEN;
+					}
+					++ip;
 				}
-				default:
-					throw ERROR_UNEXPECTED_TOKEN;
+			}
+			catch (int) {
+				if (!error_located) {
+					err_tok = code->get_statement(ip);
+					error_located = true;
 				}
+				throw;
 			}
-			return nullptr;
+			registers[result].set_value(value(VALUE_TYPE_NULL, nullptr));
+			register_top = register_base;
 		}
 	}
 }
\ No newline at end of file
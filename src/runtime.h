@@ -5,7 +5,10 @@
 
 #include <unordered_map>
 #include <stack>
+#include <vector>
 #include <unordered_set>
+#include <utility>
+#include <string>
 
 #include "errors.h"
 #include "value.h"
@@ -16,112 +19,235 @@
 #include "builtins.h"
 #include "structure.h"
 #include "lexer.h"
+#include "bytecode.h"
 #include "hash.h"
 
-#define VALUE_EVAL_TYPE_REF 0
-#define VALUE_EVAL_TYPE_VAL 1
+//initial capacities of the call stack, it's variable slots and it's registers
+#define CALL_STACK_RESERVE 256
+#define FRAME_STACK_RESERVE 4096
+#define REGISTER_STACK_RESERVE 4096
+
+//what a for loop iterates over
+#define FOR_ITERATE_COLLECTION 0 //binds the loop variable to each element's apartment, boxing a packed element only until the loop moves on
+#define FOR_ITERATE_RANGE 1 //counts through a range, binding the loop variable to a fresh number each iteration
 
 namespace fastcode {
 	namespace runtime {
+		class collection;
+
 		class interpreter {
 		private:
-			class call_frame {
-			private:
-				garbage_collector* garbage_collector;
-
-			public:
-				variable_manager* manager;
+			//a procedure's frame, it's variables are carved from a slot range in a shared, contiguous stack
+			struct call_frame {
 				parsing::function_prototype* prototype;
+				variable_manager* locals;
+				unsigned int base;
 
-				call_frame(parsing::function_prototype* prototype, class garbage_collector* garbage_collector);
-				~call_frame();
+				call_frame(parsing::function_prototype* prototype, variable_manager* locals, unsigned int base) : prototype(prototype), locals(locals), base(base) {}
 			};
 
-			struct value_eval {
-			private:
-				bool keep_val;
-				void* ptr;
+			//a register holds an instruction's operand or result; primitive values are held inline rather than on the heap, anything else is referenced
+			//registers are garbage collection roots while their frame executes
+			struct value_register {
+				reference_apartment* reference;
+				value val;
 
-				value_eval(void* ret_obj, unsigned char type, bool keep_val) {
-					this->type = type;
-					this->ptr = ret_obj;
-					this->keep_val = keep_val;
-				}
+				value_register() : reference(nullptr), val(VALUE_TYPE_NULL, nullptr) {}
 
-			public:
-				unsigned char type;
+				inline value* get_value() {
+					if (this->reference != nullptr)
+						return this->reference->value;
+					return &this->val;
+				}
 
-				explicit value_eval(reference_apartment* reference) : value_eval(reference, VALUE_EVAL_TYPE_REF, true) {}
-				explicit value_eval(value* value) : value_eval(value, VALUE_EVAL_TYPE_VAL, false) {}
+				inline void set_reference(reference_apartment* reference) {
+					this->reference = reference;
+				}
 
-				~value_eval() {
-					if (this->type == VALUE_EVAL_TYPE_VAL && !keep_val)
-						delete (value*)this->ptr;
+				inline void set_value(value&& val) {
+					this->reference = nullptr;
+					this->val = std::move(val);
 				}
 
-				inline void keep() {
-					this->keep_val = true;
+				//copies a primitive value inline
+				inline void set_primitive(value* primitive) {
+					this->reference = nullptr;
+					this->val.assign_primitive(*primitive);
 				}
 
-				inline reference_apartment* get_reference() {
-					return (reference_apartment*)this->ptr;
+				inline void set_numerical(long double numerical) {
+					this->reference = nullptr;
+					this->val.type = VALUE_TYPE_NUMERICAL;
+					this->val.numerical = numerical;
 				}
 
-				inline value* get_value() {
-					if (this->type == VALUE_EVAL_TYPE_REF) {
-						return get_reference()->value;
-					}
-					return (value*)this->ptr;
+				//moves an inline value onto the heap so a reference apartment can take ownership of it
+				inline value* release() {
+					return new value(std::move(this->val));
 				}
 			};
 
+			//a packed element boxed to be lent to a single variable, without boxing the rest of it's collection
+			//the apartment is the element's only storage while it's lent, and is unboxed afterwards unless it's been shared
+			struct lent_element {
+				//the apartment of the collection the element was lent from
+				reference_apartment* lender;
+				unsigned long index;
+
+				//the element's apartment, or null if nothing's lent
+				reference_apartment* element;
+
+				lent_element() : lender(nullptr), index(0), element(nullptr) {}
+			};
+
+			//the iteration state of an executing for loop
+			struct for_iterator {
+				char kind;
+				unsigned long index;
+
+				//the collection being iterated, and it's apartment which is kept alive while iterating
+				reference_apartment* reference;
+				collection* to_iterate;
+
+				//the packed element lent to the loop variable
+				lent_element lent;
+
+				//a streamed range, which yields start + index * step until index reaches size
+				long double start;
+				long double step;
+				unsigned long size;
+			};
+
 			variable_manager* static_var_manager;
+			variable_manager* global_var_manager;
+			variable_manager* frame_stack;
 			garbage_collector garbage_collector;
-			std::stack<call_frame*> call_stack;
+			std::vector<call_frame> call_stack;
 
-			std::unordered_map<unsigned long, fastcode::parsing::structure_prototype*> struct_definitions;
-			std::unordered_map<unsigned long, parsing::function_prototype*> function_definitions;
-			std::unordered_map<unsigned long, builtins::built_in_function> built_in_functions;
+			//the registers of every executing frame, a frame's registers are above it's caller's
+			//registers above the top are left allocated for the next frame rather than being destroyed on every return
+			std::vector<value_register> registers;
+			unsigned int register_top;
 
-			std::unordered_set<unsigned long> included_files;
+			parsing::symbol_table global_symbols;
 
-			struct parsing::lexer::lexer_state lexer_state;
+			//the variables of the executing call frame
+			inline variable_manager* locals() {
+				return call_stack.back().locals;
+			}
+
+			//gets a variable's slot within the executing call frame
+			inline unsigned int local_slot(parsing::identifier_token* identifier) {
+				return call_stack.back().base + identifier->slot;
+			}
+			std::vector<for_iterator> for_stack;
+
+			//the packed elements lent to procedures as arguments, a call unboxes it's own once it returns
+			std::vector<lent_element> lent_arguments;
+
+			//boxes a packed element to lend it to a single variable
+			reference_apartment* lend(lent_element& lent, collection* lender, unsigned long index);
 
-			bool break_mode;
+			//unboxes a lent element once it's variable is done with it, unless it's collection has been replaced since
+			void unbox(lent_element& lent);
 
-			void set_ref(parsing::variable_access_token* access, reference_apartment* reference);
-			reference_apartment* get_ref(parsing::variable_access_token* access);
+			//definitions are indexed by their identifier's symbol id, undefined symbols are null
+			std::vector<parsing::structure_prototype*> struct_definitions;
+			std::vector<parsing::function_prototype*> function_definitions;
+			std::vector<builtins::built_in_function> built_in_functions;
 
-			inline value* get_val(parsing::variable_access_token* access) {
-				return get_ref(access)->value;
+			template<typename T>
+			static inline T find_definition(const std::vector<T>& definitions, unsigned int symbol_id) {
+				return symbol_id < definitions.size() ? definitions[symbol_id] : nullptr;
 			}
 
-			inline void set_val(parsing::variable_access_token* access, value* val) {
-				get_ref(access)->set_value(val);
+			//adds a definition, or throws an error if the symbol is already defined
+			template<typename T>
+			static inline void add_definition(std::vector<T>& definitions, unsigned int symbol_id, T definition, int defined_error) {
+				if (find_definition(definitions, symbol_id) != nullptr)
+					throw defined_error;
+				if (symbol_id >= definitions.size())
+					definitions.resize(parsing::get_symbols().size(), nullptr);
+				definitions[symbol_id] = definition;
 			}
 
-			/*
-			* IMPORTANT NOTE:
-			Value eval must be returned as a pointer because C++ often messes around with when we return it. Using a pointer just keeps one singular version.
-			*/
+			//bumped whenever a procedure or built in function is defined, invalidating every call site's cached resolution
+			unsigned int definition_generation;
 
+			//resolves a call site to a procedure or built in function, and caches it on the call
+			inline void resolve_call(parsing::function_call_token* func_call) {
+				func_call->resolved_prototype = find_definition(function_definitions, func_call->identifier->symbol_id);
+				func_call->resolved_built_in = find_definition(built_in_functions, func_call->identifier->symbol_id);
+				func_call->resolved_generation = definition_generation;
+			}
+
+			std::unordered_set<unsigned long> included_files;
+
+			//the path of every file that's been included, which images record
+			std::vector<std::string> included_paths;
+
+			//files that were already ran when the image the interpreter booted from was written, including them again does nothing
+			std::unordered_set<std::string> image_files;
+
+			struct parsing::lexer::lexer_state lexer_state;
+
+			//gets the apartment of a variable
+			inline reference_apartment* get_var_ref(parsing::identifier_token* identifier) {
+				if (static_var_manager->has_var(identifier->static_slot))
+					return static_var_manager->get_var_reference(identifier->static_slot);
+				else if (locals()->has_var(local_slot(identifier)))
+					return locals()->get_var_reference(local_slot(identifier));
+				throw ERROR_UNRECOGNIZED_VARIABLE;
+			}
+
+			//loads an apartment into a register, primitives are copied unless they're loaded by reference
+			//a referenced apartment is shared, since a lent element mustn't be unboxed while something else holds it
+			static inline void load(value_register& reg, reference_apartment* reference, bool by_reference) {
+				if (by_reference || !reference->value->is_primitive()) {
+					reference->share();
+					reg.set_reference(reference);
+				}
+				else
+					reg.set_primitive(reference->value);
+			}
 
-			//evaluates a reference or value
-			value_eval* evaluate(parsing::token* token, bool force_reference);
+			//makes a resolved call, whose arguments are in the registers following the result register
+			void call(parsing::function_call_token* func_call, unsigned int result);
 
-			//executes a block of tokens
-			value_eval* execute_block(std::list<parsing::token*> tokens);
+			//executes a compiled block of instructions, storing it's return value, or null if it doesn't return anything, in the result register
+			void execute(parsing::bytecode* code, unsigned int result);
+
+			//whether the statement that threw the error being unwound has been recorded, the innermost frame records it
+			bool error_located;
 
 			bool multi_sweep;
 
+			//lexes source code, returns false after reporting a syntax error
+			bool tokenize(const char* source, unsigned long source_length, bool interactive_mode, std::vector<parsing::token*>& tokens);
+
+			//compiles and runs lexed top level tokens, which are freed afterwards unless they've been internalized
+			long double run_tokens(std::vector<parsing::token*>& to_execute, const char* source, unsigned long source_length);
+
+			//runs an included file, loading it's tokens from it's module cache if it's up to date, or lexing it and writing the cache otherwise
+			long double run_module(const char* file_path, const char* source, unsigned long source_length);
+
+			//marks every root and frees whatever can't be reached from them, or advances an incremental collection by a step
+			void collect_garbage();
+
+			//collects garbage if enough has been allocated since the last collection, only call between statements
+			inline void safe_point() {
+				if (garbage_collector.should_collect())
+					collect_garbage();
+			}
+
 			inline bool tok_internalized(parsing::token* tok) {
 				if (tok->type == TOKEN_STRUCT_PROTO) {
 					parsing::structure_prototype* proto = (parsing::structure_prototype*)tok;
-					return this->struct_definitions[proto->identifier->id_hash] == proto;
+					return find_definition(this->struct_definitions, proto->identifier->symbol_id) == proto;
 				}
 				else if (tok->type == TOKEN_FUNC_PROTO) {
 					parsing::function_prototype* proto = (parsing::function_prototype*)tok;
-					return this->function_definitions[proto->identifier->id_hash] == proto;
+					return find_definition(this->function_definitions, proto->identifier->symbol_id) == proto;
 				}
 				return false;
 			}
@@ -131,28 +257,36 @@ namespace fastcode {
 			//last token, often is error token
 			parsing::token* err_tok;
 
-			interpreter(bool multi_sweep);
+			//a non-zero step budget makes major collections incremental, bounding each pause to about that many apartments
+			interpreter(bool multi_sweep, unsigned int gc_step_budget = 0);
 			~interpreter();
 
-			long double run(const char* source, bool interactive_mode);
+			//runs source code, which doesn't have to be null terminated
+			long double run(const char* source, unsigned long source_length, bool interactive_mode);
+
+			inline long double run(const char* source, bool interactive_mode) {
+				return run(source, (unsigned long)std::strlen(source), interactive_mode);
+			}
 
 			void include(const char* file_path);
 
+			//writes the procedures, structs, constants and module level variables to an image, returns false if it couldn't be written, such as when a variable holds a handle
+			bool save_image(const char* path);
+
+			//restores an image, built in functions and structs have to be imported beforehand; returns false if the image is missing or malformed
+			bool load_image(const char* path);
+
 			inline void import_func(const char* identifier, builtins::built_in_function function) {
-				unsigned long id_hash = insecure_hash(identifier);
-				if (built_in_functions.count(id_hash))
-					throw ERROR_FUNCTION_PROTO_ALREADY_DEFINED;
-				built_in_functions[id_hash] = function;
+				add_definition(built_in_functions, parsing::get_symbols().intern(identifier), function, ERROR_FUNCTION_PROTO_ALREADY_DEFINED);
+				definition_generation++;
 			}
 
 			inline void import_struct(parsing::structure_prototype* struct_proto) {
-				if (struct_definitions.count(struct_proto->identifier->id_hash))
-					throw ERROR_STRUCT_PROTO_ALREADY_DEFINED;
-				struct_definitions[struct_proto->identifier->id_hash] = struct_proto;
+				add_definition(struct_definitions, struct_proto->identifier->symbol_id, struct_proto, ERROR_STRUCT_PROTO_ALREADY_DEFINED);
 			}
 
 			inline void new_constant(const char* identifier, value* val) {
-				this->lexer_state.constants[insecure_hash(identifier)] = new parsing::value_token(val);
+				this->lexer_state.define_constant(parsing::get_symbols().intern(identifier), new parsing::value_token(val));
 			}
 		};
 	}
@@ -0,0 +1,22 @@
+#include "slab.h"
+
+namespace fastcode {
+	slab::~slab() {
+		while (this->blocks != nullptr)
+		{
+			block* to_delete = this->blocks;
+			this->blocks = to_delete->next;
+			::operator delete(to_delete);
+		}
+	}
+
+	void slab::new_block() {
+		//the first slot of a block links it to the previous block
+		char* memory = (char*)::operator new(this->object_size * (SLAB_BLOCK_OBJECTS + 1));
+		block* new_block = (block*)memory;
+		new_block->next = this->blocks;
+		this->blocks = new_block;
+		this->block_cursor = memory + this->object_size;
+		this->block_end = memory + this->object_size * (SLAB_BLOCK_OBJECTS + 1);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,60 @@
+#pragma once
+
+#ifndef SLAB_H
+#define SLAB_H
+
+#include <cstddef>
+
+//the amount of objects carved out of every block a slab allocates
+#define SLAB_BLOCK_OBJECTS 1024
+
+namespace fastcode {
+	//a fixed size object allocator; objects are carved out of large blocks, and freed objects are recycled through an intrusive free list
+	class slab {
+	private:
+		struct free_object {
+			free_object* next;
+		};
+
+		//blocks are chained through their first slot, so they can be freed together
+		struct block {
+			block* next;
+		};
+
+		std::size_t object_size;
+		free_object* free_list;
+		block* blocks;
+		char* block_cursor;
+		char* block_end;
+
+		void new_block();
+
+	public:
+		//slabs are constant initialized, so objects with static storage can be allocated from them at any time
+		constexpr slab(std::size_t object_size) : object_size(((object_size < sizeof(free_object) ? sizeof(free_object) : object_size) + alignof(std::max_align_t) - 1) / alignof(std::max_align_t) * alignof(std::max_align_t)), free_list(nullptr), blocks(nullptr), block_cursor(nullptr), block_end(nullptr) {}
+		~slab();
+
+		slab(const slab&) = delete;
+
+		inline void* allocate() {
+			if (this->free_list != nullptr) {
+				free_object* object = this->free_list;
+				this->free_list = object->next;
+				return object;
+			}
+			if (this->block_cursor == this->block_end)
+				new_block();
+			void* object = this->block_cursor;
+			this->block_cursor += this->object_size;
+			return object;
+		}
+
+		inline void release(void* object) {
+			free_object* freed = (free_object*)object;
+			freed->next = this->free_list;
+			this->free_list = freed;
+		}
+	};
+}
+
+#endif // !SLAB_H
\ No newline at end of file
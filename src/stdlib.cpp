@@ -8,7 +8,7 @@
 
 namespace fastcode {
 	namespace builtins {
-		runtime::reference_apartment* get_handle(const std::vector<value*> arguments, runtime::garbage_collector* gc) {
+		runtime::reference_apartment* get_handle(const std::vector<value*>& arguments, runtime::garbage_collector* gc) {
 			match_arg_len(arguments, 1);
 			if (arguments[0]->type == VALUE_TYPE_STRUCT) {
 				return gc->new_apartment(new value(VALUE_TYPE_HANDLE, ((runtime::structure*)arguments[0]->ptr)->get_parent_ref()));
@@ -19,7 +19,7 @@ namespace fastcode {
 			throw ERROR_INVALID_VALUE_TYPE;
 		}
 
-		runtime::reference_apartment* set_struct_property(const std::vector<value*> arguments, runtime::garbage_collector* gc) {
+		runtime::reference_apartment* set_struct_property(const std::vector<value*>& arguments, runtime::garbage_collector* gc) {
 			match_arg_len(arguments, 3);
 			match_arg_type(arguments[0], VALUE_TYPE_STRUCT);
 			match_arg_type(arguments[1], VALUE_TYPE_NUMERICAL);
@@ -43,14 +43,13 @@ namespace fastcode {
 			return gc->new_apartment(new value(VALUE_TYPE_NULL, nullptr));
 		}
 
-		runtime::reference_apartment* abort_program(const std::vector<value*> arguments, runtime::garbage_collector* gc) {
+		runtime::reference_apartment* abort_program(const std::vector<value*>& arguments, runtime::garbage_collector* gc) {
 			if (arguments.size() > 0) {
 				std::cout << "The program was aborted with the following message:" << std::endl;
 				for (auto i = arguments.begin(); i != arguments.end(); ++i) {
 					if ((*i)->type == VALUE_TYPE_COLLECTION) {
-						char* msg = to_c_str(*i);
-						std::cout << msg;
-						delete[] msg;
+						string_arg msg(*i);
+						std::cout << msg.c_str();
 					}
 					else if ((*i)->type == VALUE_TYPE_CHAR)
 						std::cout << *(*i)->get_char();
@@ -62,9 +61,9 @@ namespace fastcode {
 			throw ERROR_ABORTED;
 		}
 
-		runtime::reference_apartment* get_hash(const std::vector<value*> arguments, runtime::garbage_collector* gc) {
+		runtime::reference_apartment* get_hash(const std::vector<value*>& arguments, runtime::garbage_collector* gc) {
 			match_arg_len(arguments, 1);
-			return gc->new_apartment(new value(VALUE_TYPE_NUMERICAL, new double((unsigned int)arguments[0]->hash())));
+			return gc->new_apartment(new value((long double)(unsigned int)arguments[0]->hash()));
 		}
 	}
 }
\ No newline at end of file
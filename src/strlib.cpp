@@ -0,0 +1,221 @@
+#include <string>
+#include <cstring>
+#include "interner.h"
+#include "builtins.h"
+#include "structure.h"
+#include "strlib.h"
+
+namespace fastcode {
+	namespace builtins {
+		namespace strlib {
+			//property symbols of the lexer structure declared in strlib.txt
+			static const unsigned int str_symbol = parsing::get_symbols().intern("_str");
+			static const unsigned int index_symbol = parsing::get_symbols().intern("_index");
+			static const unsigned int last_char_symbol = parsing::get_symbols().intern("last_char");
+			static const unsigned int excluded_symbol = parsing::get_symbols().intern("excluded_chars");
+			static const unsigned int size_symbol = parsing::get_symbols().intern("size");
+
+			inline runtime::collection* collection_arg(value* value) {
+				match_arg_type(value, VALUE_TYPE_COLLECTION);
+				return (runtime::collection*)value->ptr;
+			}
+
+			//gets a char element without widening strings
+			inline char char_at(runtime::collection* collection, unsigned long index) {
+				if (collection->get_string() != nullptr)
+					return collection->get_string()[index];
+				value* element = collection->get_value(index);
+				match_arg_type(element, VALUE_TYPE_CHAR);
+				return element->character;
+			}
+
+			//checks if a collection has a char, comparing elements the same way count@linq does
+			static bool has_char(runtime::collection* chars, char c) {
+				if (chars->get_string() != nullptr)
+					return std::memchr(chars->get_string(), c, chars->size) != nullptr;
+				value char_value(c);
+				for (unsigned long i = 0; i < chars->size; i++)
+					if (char_value.compare(chars->get_value(i)) == 0)
+						return true;
+				return false;
+			}
+
+			//checks if a pattern matches at an index, the same as match@pattern
+			static bool match(runtime::collection* base, unsigned long index, runtime::collection* pattern) {
+				if (index + pattern->size > base->size)
+					return false;
+				for (unsigned long i = 0; i < pattern->size; i++) {
+					value base_char(char_at(base, index + i));
+					if (pattern->get_string() != nullptr ? base_char.character != pattern->get_string()[i] : base_char.compare(pattern->get_value(i)) != 0)
+						return false;
+				}
+				return true;
+			}
+
+			//a lexer's state, read out of it's structure and written back once a native read finishes
+			class lexer_state {
+			private:
+				runtime::structure* lexer;
+				runtime::collection* str;
+				runtime::collection* excluded_chars;
+				unsigned long size;
+
+			public:
+				unsigned long index;
+				char last_char;
+				bool eos;
+
+				explicit lexer_state(value* lexer_value) {
+					match_arg_type(lexer_value, VALUE_TYPE_STRUCT);
+					this->lexer = (runtime::structure*)lexer_value->ptr;
+					this->str = collection_arg(lexer->get_value(str_symbol));
+					this->excluded_chars = collection_arg(lexer->get_value(excluded_symbol));
+
+					value* index_value = lexer->get_value(index_symbol);
+					value* size_value = lexer->get_value(size_symbol);
+					match_arg_type(index_value, VALUE_TYPE_NUMERICAL);
+					match_arg_type(size_value, VALUE_TYPE_NUMERICAL);
+					this->index = (unsigned long)index_value->numerical;
+					this->size = (unsigned long)size_value->numerical;
+
+					//the end of the stream is marked by a last char of 0
+					value* last_char_value = lexer->get_value(last_char_symbol);
+					value zero((long double)0);
+					this->eos = last_char_value->compare(&zero) == 0;
+					this->last_char = this->eos ? 0 : *last_char_value->get_char();
+				}
+
+				//advances to the next char that isn't excluded
+				inline void read_char() {
+					do {
+						if (this->index == this->size) {
+							this->eos = true;
+							this->last_char = 0;
+							return;
+						}
+						this->last_char = char_at(this->str, this->index++);
+					} while (this->excluded_chars->size > 0 && has_char(this->excluded_chars, this->last_char));
+					this->eos = this->last_char == 0;
+				}
+
+				inline bool match(runtime::collection* pattern) {
+					return strlib::match(this->str, this->index - 1, pattern);
+				}
+
+				inline value get_last_char() {
+					if (this->eos)
+						return value((long double)0);
+					return value(this->last_char);
+				}
+
+				//writes the lexer's position back into it's structure
+				void commit() {
+					value new_index((long double)this->index);
+					value new_last_char = get_last_char();
+					lexer->get_reference(index_symbol)->set_primitive(&new_index);
+					lexer->get_reference(last_char_symbol)->set_primitive(&new_last_char);
+				}
+			};
+
+			inline runtime::reference_apartment* new_string(const std::string& buffer, runtime::garbage_collector* gc) {
+				return (new runtime::collection(buffer.data(), (unsigned long)buffer.size(), gc))->get_parent_ref();
+			}
+
+			runtime::reference_apartment* builder(const std::vector<value*>& arguments, runtime::garbage_collector* gc) {
+				match_arg_len(arguments, 0);
+				return (new runtime::collection("", 0, gc))->get_parent_ref();
+			}
+
+			runtime::reference_apartment* append_c(const std::vector<value*>& arguments, runtime::garbage_collector* gc) {
+				match_arg_len(arguments, 2);
+				runtime::collection* builder = collection_arg(arguments[0]);
+				match_arg_type(arguments[1], VALUE_TYPE_CHAR);
+				if (builder->get_string() == nullptr || builder->is_view())
+					throw ERROR_INVALID_VALUE_TYPE;
+				builder->append_string(arguments[1]->get_char(), 1);
+				return gc->new_apartment(new value(VALUE_TYPE_NULL, nullptr));
+			}
+
+			runtime::reference_apartment* append(const std::vector<value*>& arguments, runtime::garbage_collector* gc) {
+				match_arg_len(arguments, 2);
+				runtime::collection* builder = collection_arg(arguments[0]);
+				if (builder->get_string() == nullptr || builder->is_view())
+					throw ERROR_INVALID_VALUE_TYPE;
+				string_arg str(arguments[1]);
+				builder->append_string(str.c_str(), str.size());
+				return gc->new_apartment(new value(VALUE_TYPE_NULL, nullptr));
+			}
+
+			runtime::reference_apartment* build(const std::vector<value*>& arguments, runtime::garbage_collector* gc) {
+				match_arg_len(arguments, 1);
+				string_arg str(arguments[0]);
+				return (new runtime::collection(str.c_str(), str.size(), gc))->get_parent_ref();
+			}
+
+			runtime::reference_apartment* read_char(const std::vector<value*>& arguments, runtime::garbage_collector* gc) {
+				match_arg_len(arguments, 1);
+				lexer_state lexer(arguments[0]);
+				lexer.read_char();
+				lexer.commit();
+				return gc->new_apartment(new value(lexer.get_last_char()));
+			}
+
+			runtime::reference_apartment* read_till_c(const std::vector<value*>& arguments, runtime::garbage_collector* gc) {
+				match_arg_len(arguments, 2);
+				lexer_state lexer(arguments[0]);
+				runtime::collection* stopchars = collection_arg(arguments[1]);
+				if (lexer.eos)
+					return gc->new_apartment(new value(VALUE_TYPE_NULL, nullptr));
+				std::string buffer;
+				while (!lexer.eos && !has_char(stopchars, lexer.last_char)) {
+					buffer.push_back(lexer.last_char);
+					lexer.read_char();
+				}
+				lexer.commit();
+				return new_string(buffer, gc);
+			}
+
+			runtime::reference_apartment* read_while(const std::vector<value*>& arguments, runtime::garbage_collector* gc) {
+				match_arg_len(arguments, 2);
+				lexer_state lexer(arguments[0]);
+				runtime::collection* stopchars = collection_arg(arguments[1]);
+				if (lexer.eos)
+					return gc->new_apartment(new value(VALUE_TYPE_NULL, nullptr));
+				std::string buffer;
+				while (!lexer.eos && has_char(stopchars, lexer.last_char)) {
+					buffer.push_back(lexer.last_char);
+					lexer.read_char();
+				}
+				lexer.commit();
+				return new_string(buffer, gc);
+			}
+
+			runtime::reference_apartment* read_till(const std::vector<value*>& arguments, runtime::garbage_collector* gc) {
+				match_arg_len(arguments, 2);
+				lexer_state lexer(arguments[0]);
+				runtime::collection* pattern = collection_arg(arguments[1]);
+				if (lexer.eos)
+					return gc->new_apartment(new value(VALUE_TYPE_NULL, nullptr));
+				std::string buffer;
+				while (!lexer.eos && !lexer.match(pattern)) {
+					buffer.push_back(lexer.last_char);
+					lexer.read_char();
+				}
+				lexer.commit();
+				return new_string(buffer, gc);
+			}
+
+			runtime::reference_apartment* read_end(const std::vector<value*>& arguments, runtime::garbage_collector* gc) {
+				match_arg_len(arguments, 1);
+				lexer_state lexer(arguments[0]);
+				std::string buffer;
+				while (!lexer.eos) {
+					buffer.push_back(lexer.last_char);
+					lexer.read_char();
+				}
+				lexer.commit();
+				return new_string(buffer, gc);
+			}
+		}
+	}
+}
\ No newline at end of file
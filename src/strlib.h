@@ -0,0 +1,31 @@
+#pragma once
+
+#ifndef STRLIB_H
+#define STRLIB_H
+
+#include <vector>
+#include "garbage.h"
+#include "references.h"
+#include "value.h"
+
+namespace fastcode {
+	namespace builtins {
+		//native internals of stl/strlib.txt, builders are growable strings and lexers are scanned in place
+		namespace strlib {
+			//string building
+			runtime::reference_apartment* builder(const std::vector<value*>& arguments, runtime::garbage_collector* gc);
+			runtime::reference_apartment* append_c(const std::vector<value*>& arguments, runtime::garbage_collector* gc);
+			runtime::reference_apartment* append(const std::vector<value*>& arguments, runtime::garbage_collector* gc);
+			runtime::reference_apartment* build(const std::vector<value*>& arguments, runtime::garbage_collector* gc);
+
+			//tokenization, operating on a strlib lexer structure
+			runtime::reference_apartment* read_char(const std::vector<value*>& arguments, runtime::garbage_collector* gc);
+			runtime::reference_apartment* read_till_c(const std::vector<value*>& arguments, runtime::garbage_collector* gc);
+			runtime::reference_apartment* read_while(const std::vector<value*>& arguments, runtime::garbage_collector* gc);
+			runtime::reference_apartment* read_till(const std::vector<value*>& arguments, runtime::garbage_collector* gc);
+			runtime::reference_apartment* read_end(const std::vector<value*>& arguments, runtime::garbage_collector* gc);
+		}
+	}
+}
+
+#endif // !STRLIB_H
\ No newline at end of file
@@ -4,7 +4,7 @@
 #define STRUCT_H
 
 #include <list>
-#include <unordered_map>
+#include <vector>
 #include "tokens.h"
 #include "references.h"
 #include "garbage.h"
@@ -13,8 +13,9 @@ namespace fastcode {
 	namespace parsing {
 		class structure_prototype : public token {
 		private:
-			std::unordered_map<unsigned long, unsigned int> property_indicies;
-			std::list<identifier_token*> properties;
+			//the symbol ids of the properties, in order; prototypes have few properties so they're searched linearly
+			std::vector<unsigned int> property_symbols;
+			std::vector<identifier_token*> properties;
 		public:
 
 			identifier_token* identifier;
@@ -22,22 +23,27 @@ namespace fastcode {
 			unsigned int property_count;
 
 			structure_prototype(const char* identifier, const char* properties[], unsigned int property_count);
-			structure_prototype(identifier_token* identifier, std::list<identifier_token*> properties);
+			structure_prototype(identifier_token* identifier, const std::vector<identifier_token*>& properties);
 			~structure_prototype();
 
 			//gets the index of a property
-			inline unsigned int get_index(unsigned long id_hash) {
-				if (!this->property_indicies.count(id_hash))
-					throw ERROR_PROPERTY_NOT_FOUND;
-				return this->property_indicies[id_hash];
+			inline unsigned int get_index(unsigned int symbol_id) {
+				for (unsigned int i = 0; i < this->property_count; i++)
+					if (this->property_symbols[i] == symbol_id)
+						return i;
+				throw ERROR_PROPERTY_NOT_FOUND;
 			}
 
-			//gets the index of a property
+			//gets the index of a property, the identifier caches it so repeated accesses on the same prototype skip the lookup
 			inline unsigned int get_index(identifier_token* identifier) {
-				return get_index(identifier->id_hash);
+				if (identifier->cached_prototype != this) {
+					identifier->cached_index = get_index(identifier->symbol_id);
+					identifier->cached_prototype = this;
+				}
+				return identifier->cached_index;
 			}
 
-			inline std::list<identifier_token*> get_properties() {
+			inline const std::vector<identifier_token*>& get_properties() {
 				return this->properties;
 			}
 
@@ -51,14 +57,19 @@ namespace fastcode {
 			reference_apartment* parent_reference;
 			parsing::structure_prototype* prototype;
 			reference_apartment** properties;
-			structure(parsing::structure_prototype* prototype, reference_apartment* parent_reference);
+			garbage_collector* gc;
+			structure(parsing::structure_prototype* prototype, reference_apartment* parent_reference, garbage_collector* gc);
 
 		public:
 			structure(parsing::structure_prototype* prototype, garbage_collector* gc);
 			~structure();
 
+			//structure headers are allocated from a shared slab, their properties are not
+			static void* operator new(std::size_t size);
+			static void operator delete(void* ptr, std::size_t size);
+
 			//sets the reference of a property
-			void set_reference(unsigned long id_hash, reference_apartment* reference);
+			void set_reference(unsigned int symbol_id, reference_apartment* reference);
 
 			//sets a reference at a property's index
 			void set_reference_at(unsigned int index, reference_apartment* reference);
@@ -73,12 +84,12 @@ namespace fastcode {
 
 			//sets the reference of a property
 			inline void set_reference(parsing::identifier_token* identifier, reference_apartment* reference) {
-				set_reference(identifier->id_hash, reference);
+				set_reference_at(this->prototype->get_index(identifier), reference);
 			}
 
 			//sets the value of a property
-			inline void set_value(unsigned long id_hash, value* value) {
-				this->properties[this->prototype->get_index(id_hash)]->set_value(value);
+			inline void set_value(unsigned int symbol_id, value* value) {
+				this->properties[this->prototype->get_index(symbol_id)]->set_value(value);
 			}
 
 			inline void set_value_at(unsigned int index, value* value) {
@@ -87,27 +98,27 @@ namespace fastcode {
 
 			//sets the value of a property
 			inline void set_value(parsing::identifier_token* identifier, value* value) {
-				set_value(identifier->id_hash, value);
+				set_value_at(this->prototype->get_index(identifier), value);
 			}
 
 			//gets the reference of a property
-			inline reference_apartment* get_reference(unsigned long id_hash) {
-				return this->properties[this->prototype->get_index(id_hash)];
+			inline reference_apartment* get_reference(unsigned int symbol_id) {
+				return this->properties[this->prototype->get_index(symbol_id)];
 			}
 
 			//gets the reference of a property
 			inline reference_apartment* get_reference(parsing::identifier_token* identifier) {
-				return get_reference(identifier->id_hash);
+				return this->properties[this->prototype->get_index(identifier)];
 			}
 
 			//gets the value of a property
-			inline value* get_value(unsigned long id_hash) {
-				return get_reference(id_hash)->value;
+			inline value* get_value(unsigned int symbol_id) {
+				return get_reference(symbol_id)->value;
 			}
 
 			//gets the value of a property
 			inline value* get_value(parsing::identifier_token* identifier) {
-				return get_value(identifier->id_hash);
+				return get_reference(identifier)->value;
 			}
 
 			inline unsigned int get_size() {
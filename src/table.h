@@ -0,0 +1,93 @@
+#pragma once
+
+#ifndef TABLE_H
+#define TABLE_H
+
+#include "references.h"
+#include "garbage.h"
+#include "value.h"
+
+#define TABLE_MIN_CAPACITY 8
+
+//slot markers, any other slot holds an entry's index plus one
+#define TABLE_SLOT_EMPTY 0
+#define TABLE_SLOT_REMOVED 0xFFFFFFFF
+
+namespace fastcode {
+	namespace runtime {
+		//an open addressing hash table, backing both maps and sets
+		//entries are kept densely in insertion order as key apartments (followed by value apartments for maps), so the collector can trace them like any other children
+		//the slots only index into the entries, and removing an entry moves the last one into it's place
+		class table {
+		private:
+			reference_apartment* parent_reference;
+			reference_apartment** entries;
+			unsigned int* entry_hashes;
+			unsigned int* slots;
+			unsigned int capacity;
+			unsigned int entry_capacity;
+			unsigned int removed_slots;
+			bool map;
+			garbage_collector* gc;
+
+			//finds the slot of a key, or the slot it would be inserted at if it isn't in the table
+			unsigned int find_slot(value* key, unsigned int hash, bool* found);
+
+			//finds the slot that points to an entry
+			unsigned int find_entry_slot(unsigned int entry, unsigned int hash);
+
+			//reallocates the slots, dropping removed markers
+			void rehash(unsigned int new_capacity);
+
+		public:
+			unsigned int size;
+
+			table(bool map, garbage_collector* gc);
+			~table();
+
+			inline bool is_map() {
+				return this->map;
+			}
+
+			//apartments per entry
+			inline unsigned int get_stride() {
+				return this->map ? 2 : 1;
+			}
+
+			//gets the entry index of a key, or -1 if it isn't in the table
+			long find(value* key);
+
+			//inserts a key, or sets the value of an existing key; returns whether the key is new
+			bool insert(reference_apartment* key, reference_apartment* value);
+
+			//removes a key, returns whether the key was in the table
+			bool remove(value* key);
+
+			inline reference_apartment* get_key(unsigned int entry) {
+				return this->entries[entry * get_stride()];
+			}
+
+			//gets a map entry's value apartment
+			inline reference_apartment* get_value(unsigned int entry) {
+				return this->entries[entry * 2 + 1];
+			}
+
+			inline reference_apartment** get_children() {
+				return this->entries;
+			}
+
+			inline reference_apartment* get_parent_ref() {
+				return this->parent_reference;
+			}
+
+			int hash();
+		};
+
+		//keys of different types never match, otherwise they're compared structurally
+		inline bool keys_equal(value* a, value* b) {
+			return a->type == b->type && a->compare(b) == 0;
+		}
+	}
+}
+
+#endif // !TABLE_H
\ No newline at end of file
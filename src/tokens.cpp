@@ -2,9 +2,35 @@
 #include "hash.h"
 #include "tokens.h"
 #include "operators.h"
+#include "bytecode.h"
+#include "structure.h"
+#include "slab.h"
+
+//the size classes tokens are allocated from
+#define TOKEN_SIZE_CLASS alignof(std::max_align_t)
+#define TOKEN_SIZE_CLASSES 6
 
 namespace fastcode {
 	namespace parsing {
+		//every kind of token fits in one of the size classes, which are an alignment apart and each have their own slab
+		static slab token_slabs[TOKEN_SIZE_CLASSES] = { slab(TOKEN_SIZE_CLASS), slab(2 * TOKEN_SIZE_CLASS), slab(3 * TOKEN_SIZE_CLASS), slab(4 * TOKEN_SIZE_CLASS), slab(5 * TOKEN_SIZE_CLASS), slab(6 * TOKEN_SIZE_CLASS) };
+
+		//anything larger than the largest size class falls back to the global heap
+		void* token::operator new(std::size_t size) {
+			std::size_t size_class = (size - 1) / TOKEN_SIZE_CLASS;
+			if (size_class >= TOKEN_SIZE_CLASSES)
+				return ::operator new(size);
+			return token_slabs[size_class].allocate();
+		}
+
+		void token::operator delete(void* ptr, std::size_t size) {
+			std::size_t size_class = (size - 1) / TOKEN_SIZE_CLASS;
+			if (size_class >= TOKEN_SIZE_CLASSES)
+				::operator delete(ptr);
+			else
+				token_slabs[size_class].release(ptr);
+		}
+
 		inline bool is_control_tok(unsigned char type) {
 			return type >= 65 && type < 70;
 		}
@@ -95,22 +121,19 @@ namespace fastcode {
 			delete inner_value_ptr;
 		}
 
-		identifier_token::identifier_token(const char* identifier) : identifier_token((char*)identifier, insecure_hash(identifier), false) {
-
-		}
+		identifier_token::identifier_token(const char* identifier) : identifier_token(get_symbols().intern(identifier)) {
 
-		identifier_token::identifier_token(char* identifier, unsigned long id_hash, bool delete_id) : token(TOKEN_IDENTIFIER) {
-			this->id_str_ptr = identifier;
-			this->id_hash = id_hash;
-			this->delete_id = delete_id;
 		}
 
-		identifier_token::~identifier_token() {
-			if (delete_id)
-				delete[] id_str_ptr;
+		identifier_token::identifier_token(unsigned int symbol_id) : token(TOKEN_IDENTIFIER) {
+			this->symbol_id = symbol_id;
+			this->slot = 0;
+			this->static_slot = 0;
+			this->cached_prototype = nullptr;
+			this->cached_index = 0;
 		}
 
-		variable_access_token::variable_access_token(const std::list<token*> modifiers) : token(TOKEN_VAR_ACCESS) {
+		variable_access_token::variable_access_token(const std::vector<token*>& modifiers) : token(TOKEN_VAR_ACCESS) {
 			this->modifiers = modifiers;
 			if (this->modifiers.size() < 1)
 				throw ERROR_INVALID_ACCESSOR_MODIFIERS;
@@ -168,9 +191,12 @@ namespace fastcode {
 			destroy_value_tok(this->value);
 		}
 
-		function_call_token::function_call_token(identifier_token* identifier, const std::list<token*> arguments) : token(TOKEN_FUNCTION_CALL) {
+		function_call_token::function_call_token(identifier_token* identifier, const std::vector<token*>& arguments) : token(TOKEN_FUNCTION_CALL) {
 			this->identifier = identifier;
 			this->arguments = arguments;
+			this->resolved_generation = 0;
+			this->resolved_prototype = nullptr;
+			this->resolved_built_in = nullptr;
 			for (auto i = this->arguments.begin(); i != this->arguments.end(); ++i)
 				if (!is_value_tok(*i))
 					throw ERROR_UNEXPECTED_TOKEN;
@@ -192,7 +218,7 @@ namespace fastcode {
 			destroy_value_tok(this->value);
 		}
 
-		conditional_token::conditional_token(unsigned char type, token* condition, const std::list<token*> instructions, conditional_token* next) : token(type) {
+		conditional_token::conditional_token(unsigned char type, token* condition, const std::vector<token*>& instructions, conditional_token* next) : token(type) {
 			if (!is_control_tok(type) || (type != TOKEN_ELSE && !is_value_tok(condition)))
 				throw ERROR_UNEXPECTED_TOKEN;
 			this->condition = condition;
@@ -228,7 +254,7 @@ namespace fastcode {
 			throw ERROR_UNRECOGNIZED_TOKEN;
 		}
 
-		for_token::for_token(identifier_token* identifier, token* collection, const std::list<token*> instructions) : token(TOKEN_FOR){
+		for_token::for_token(identifier_token* identifier, token* collection, const std::vector<token*>& instructions) : token(TOKEN_FOR){
 			this->collection = collection;
 			this->identifier = identifier;
 			this->instructions = instructions;
@@ -241,16 +267,24 @@ namespace fastcode {
 				destroy_top_lvl_tok(*i);
 		}
 
-		create_array_token::create_array_token(const std::list<token*> values) : token(TOKEN_CREATE_ARRAY) {
+		create_array_token::create_array_token(const std::vector<token*>& values) : token(TOKEN_CREATE_ARRAY) {
 			for (auto i = values.begin(); i != values.end(); ++i)
 				if (!is_value_tok(*i))
 					throw ERROR_UNEXPECTED_TOKEN;
 			this->values = values;
+			this->string = nullptr;
+			this->string_length = 0;
+		}
+
+		create_array_token::create_array_token(char* string, unsigned long string_length) : token(TOKEN_CREATE_ARRAY) {
+			this->string = string;
+			this->string_length = string_length;
 		}
 
 		create_array_token::~create_array_token() {
 			for (auto i = this->values.begin(); i != this->values.end(); ++i)
 				destroy_value_tok(*i);
+			delete[] this->string;
 		}
 
 		create_struct_token::create_struct_token(identifier_token* identifier) : token(TOKEN_CREATE_STRUCT) {
@@ -261,7 +295,7 @@ namespace fastcode {
 			delete this->identifier;
 		}
 
-		function_prototype::function_prototype(identifier_token* identifier, const std::list<identifier_token*> argument_identifiers, const std::list<token*> tokens, bool params_mode) : token(TOKEN_FUNC_PROTO) {
+		function_prototype::function_prototype(identifier_token* identifier, const std::vector<identifier_token*>& argument_identifiers, const std::vector<token*>& tokens, bool params_mode) : token(TOKEN_FUNC_PROTO) {
 			this->identifier = identifier;
 			this->argument_identifiers = argument_identifiers;
 			this->tokens = tokens;
@@ -269,10 +303,11 @@ namespace fastcode {
 			for (auto i = this->tokens.begin(); i != this->tokens.end(); ++i)
 				if (!is_top_level_tok(*i))
 					throw ERROR_UNEXPECTED_TOKEN;
-
+			this->compiled = nullptr;
 		}
 
 		function_prototype::~function_prototype() {
+			delete compiled;
 			delete identifier;
 			for (auto i = this->argument_identifiers.begin(); i != this->argument_identifiers.end(); ++i)
 				delete* i;
@@ -285,7 +320,7 @@ namespace fastcode {
 		}
 
 		include_token::~include_token() {
-			delete this->file_path;
+			delete[] this->file_path;
 		}
 	}
 }
\ No newline at end of file
@@ -4,9 +4,11 @@
 #define TOKENS_H
 
 #include <list>
+#include <vector>
 #include "errors.h"
 #include "value.h"
 #include "hash.h"
+#include "interner.h"
 
 //value and accessor tokens 0-4
 #define TOKEN_VALUE 0
@@ -49,10 +51,25 @@
 #define MAX_TOKEN_LIMIT 75
 
 namespace fastcode {
+	namespace runtime {
+		class reference_apartment;
+		class garbage_collector;
+	}
+
 	namespace parsing {
+		class bytecode;
+		class structure_prototype;
+
 		struct token {
 			unsigned char type;
 			explicit token(unsigned char type);
+
+			//tokens are often deleted through a pointer to their base
+			virtual ~token() {}
+
+			//tokens are allocated from slabs of a few size classes, so a tree's nodes of similar kinds are laid out next to each other in the order they're lexed
+			static void* operator new(std::size_t size);
+			static void operator delete(void* ptr, std::size_t size);
 		};
 
 		struct value_token :token {
@@ -64,6 +81,15 @@ namespace fastcode {
 				return this->inner_value_ptr->clone();
 			}
 
+			inline value copy_value() {
+				return this->inner_value_ptr->copy();
+			}
+
+			//gets the token's value without copying it
+			inline value* peek_value() {
+				return this->inner_value_ptr;
+			}
+
 			void print();
 		private:
 			value* inner_value_ptr;
@@ -71,38 +97,32 @@ namespace fastcode {
 
 		struct identifier_token : token {
 		public:
-			unsigned long id_hash;
+			//the dense id of the identifier's name, see interner.h
+			unsigned int symbol_id;
+
+			//frame and static slots, assigned when the enclosing code is compiled
+			unsigned int slot;
+			unsigned int static_slot;
+
+			//an inline cache of the last structure prototype this property was accessed on, and the property's index within it
+			structure_prototype* cached_prototype;
+			unsigned int cached_index;
 			
 			explicit identifier_token(const char* identifier);
-			identifier_token(char* identifier, unsigned long id_hash, bool delete_id = true);
-			~identifier_token();
-
-			inline void no_delete() {
-				this->delete_id = false;
-			}
+			explicit identifier_token(unsigned int symbol_id);
 
+			//identifiers don't own their names, they're kept by the symbol interner
 			inline const char* get_identifier() {
-				return (const char*)this->id_str_ptr;
-			}
-
-			inline void set_c_str(char* id_str) {
-				if (delete_id)
-					delete[] this->id_str_ptr;
-				delete_id = true;
-				this->id_str_ptr = id_str;
-				this->id_hash = insecure_hash(id_str);
+				return get_symbols().get_name(this->symbol_id);
 			}
 
 			void print();
-		private:
-			char* id_str_ptr;
-			bool delete_id;
 		};
 
 		struct variable_access_token : token {
-			std::list<token*> modifiers;
+			std::vector<token*> modifiers;
 			
-			variable_access_token(const std::list<token*> modifiers);
+			variable_access_token(const std::vector<token*>& modifiers);
 			~variable_access_token();
 
 			inline identifier_token* get_identifier() {
@@ -143,9 +163,14 @@ namespace fastcode {
 
 		struct function_call_token :token {
 			identifier_token* identifier;
-			std::list<token*> arguments;
+			std::vector<token*> arguments;
+
+			//what the call last resolved to, only valid while the interpreter's definition generation is unchanged
+			unsigned int resolved_generation;
+			struct function_prototype* resolved_prototype;
+			runtime::reference_apartment* (*resolved_built_in)(const std::vector<value*>& arguments, runtime::garbage_collector* gc);
 			
-			function_call_token(identifier_token* identifier, const std::list<token*> arguments);
+			function_call_token(identifier_token* identifier, const std::vector<token*>& arguments);
 			~function_call_token();
 
 			void print();
@@ -162,10 +187,10 @@ namespace fastcode {
 
 		struct conditional_token :token {
 			token* condition;
-			std::list<token*> instructions;
+			std::vector<token*> instructions;
 			conditional_token* next;
 
-			conditional_token(unsigned char type, token* condition, const std::list<token*> instructions, conditional_token* next);
+			conditional_token(unsigned char type, token* condition, const std::vector<token*>& instructions, conditional_token* next);
 			~conditional_token();
 			
 			conditional_token* get_next_conditional(bool condition_val);
@@ -175,18 +200,23 @@ namespace fastcode {
 		struct for_token : token {
 			token* collection;
 			identifier_token* identifier;
-			std::list<token*> instructions;
+			std::vector<token*> instructions;
 
-			for_token(identifier_token* identifier, token* collection, const std::list<token*> instructions);
+			for_token(identifier_token* identifier, token* collection, const std::vector<token*>& instructions);
 			~for_token();
 
 			void print(int indent = 0);
 		};
 
 		struct create_array_token :token {
-			std::list<token*> values;
+			std::vector<token*> values;
+
+			//a string literal's null terminated bytes, strings don't have any value tokens
+			char* string;
+			unsigned long string_length;
 
-			create_array_token(const std::list<token*> values);
+			create_array_token(const std::vector<token*>& values);
+			create_array_token(char* string, unsigned long string_length);
 			~create_array_token();
 
 			void print();
@@ -203,11 +233,12 @@ namespace fastcode {
 
 		struct function_prototype :token {
 			identifier_token* identifier;
-			std::list<identifier_token*> argument_identifiers;
-			std::list<token*> tokens;
+			std::vector<identifier_token*> argument_identifiers;
+			std::vector<token*> tokens;
+			bytecode* compiled;
 			bool params_mode;
 
-			function_prototype(identifier_token* identifier, const std::list<identifier_token*> argument_identifiers, const std::list<token*> tokens, bool params_mode);
+			function_prototype(identifier_token* identifier, const std::vector<identifier_token*>& argument_identifiers, const std::vector<token*>& tokens, bool params_mode);
 			~function_prototype();
 
 			void print();
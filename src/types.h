@@ -10,10 +10,10 @@
 
 namespace fastcode {
 	namespace builtins {
-		runtime::reference_apartment* get_type(const std::vector<value*> arguments, runtime::garbage_collector* gc);
-		runtime::reference_apartment* to_string(const std::vector<value*> arguments, runtime::garbage_collector* gc);
-		runtime::reference_apartment* to_numerical(const std::vector<value*> arguments, runtime::garbage_collector* gc);
-		runtime::reference_apartment* to_char(const std::vector<value*> arguments, runtime::garbage_collector* gc);
+		runtime::reference_apartment* get_type(const std::vector<value*>& arguments, runtime::garbage_collector* gc);
+		runtime::reference_apartment* to_string(const std::vector<value*>& arguments, runtime::garbage_collector* gc);
+		runtime::reference_apartment* to_numerical(const std::vector<value*>& arguments, runtime::garbage_collector* gc);
+		runtime::reference_apartment* to_char(const std::vector<value*>& arguments, runtime::garbage_collector* gc);
 	}
 }
 
@@ -1,9 +1,27 @@
 #include "errors.h"
+#include <utility>
 #include "value.h"
+#include "slab.h"
 
-#define MAX_VALUE_TYPE 5
+#define MAX_VALUE_TYPE 6
 
 namespace fastcode {
+	static slab value_slab(sizeof(value));
+
+	//anything larger than a slot, such as a derived object, falls back to the global heap
+	void* value::operator new(std::size_t size) {
+		if (size != sizeof(value))
+			return ::operator new(size);
+		return value_slab.allocate();
+	}
+
+	void value::operator delete(void* ptr, std::size_t size) {
+		if (size != sizeof(value))
+			::operator delete(ptr);
+		else
+			value_slab.release(ptr);
+	}
+
 	value::value(char type, void* ptr) {
 		if (type > MAX_VALUE_TYPE) {
 			throw ERROR_INVALID_VALUE_TYPE;
@@ -12,24 +30,45 @@ namespace fastcode {
 		this->ptr = ptr;
 	}
 
-	value* value::clone() {
-		value* clone = new value(this->type, nullptr);
+	value::value(long double numerical) {
+		this->type = VALUE_TYPE_NUMERICAL;
+		this->numerical = numerical;
+	}
+
+	value::value(char character) {
+		this->type = VALUE_TYPE_CHAR;
+		this->character = character;
+	}
+
+	value::value(value&& other) noexcept {
+		this->type = other.type;
+		copy_payload(other);
+		other.type = VALUE_TYPE_NULL;
+		other.ptr = nullptr;
+	}
+
+	value& value::operator=(value&& other) noexcept {
+		value old(std::move(*this)); //frees the old payload when it goes out of scope
+		this->type = other.type;
+		copy_payload(other);
+		other.type = VALUE_TYPE_NULL;
+		other.ptr = nullptr;
+		return *this;
+	}
+
+	value value::copy() {
 		switch (this->type)
 		{
 		case VALUE_TYPE_NULL:
-			break;
+			return value(VALUE_TYPE_NULL, nullptr);
 		case VALUE_TYPE_CHAR:
-			clone->ptr = new char(*(char*)this->ptr);
-			break;
+			return value(this->character);
 		case VALUE_TYPE_NUMERICAL:
-			clone->ptr = new long double(*(long double*)this->ptr);
-			break;
+			return value(this->numerical);
 		case VALUE_TYPE_HANDLE:
-			clone->ptr = this->ptr;
-			break;
+			return value(VALUE_TYPE_HANDLE, this->ptr);
 		default:
 			throw ERROR_INVALID_VALUE_TYPE;
 		}
-		return clone;
 	}
 }
\ No newline at end of file
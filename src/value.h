@@ -9,40 +9,87 @@
 #define VALUE_TYPE_HANDLE 3
 #define VALUE_TYPE_COLLECTION 4
 #define VALUE_TYPE_STRUCT 5
+#define VALUE_TYPE_TABLE 6
+
+#include <cstddef>
 
 namespace fastcode {
 	class value {
 	public:
 		char type;
-		void* ptr;
+
+		//primitives are stored inline, only collections and structures live on the heap
+		union {
+			void* ptr;
+			long double numerical;
+			char character;
+		};
+
 		value(char type, void* ptr);
+		explicit value(long double numerical);
+		explicit value(char character);
+		value(value&& other) noexcept;
 		~value();
 
+		//values are allocated from a shared slab rather than the general purpose heap
+		static void* operator new(std::size_t size);
+		static void operator delete(void* ptr, std::size_t size);
+
+		value& operator=(value&& other) noexcept;
+
+		//copies a primitive value, do not call unless value is primitive
+		value copy();
+
+		//overwrites a primitive value with another primitive value in place, do not call unless both values are primitive
+		inline void assign_primitive(const value& other) {
+			this->type = other.type;
+			copy_payload(other);
+		}
+
 		//do not call unless value is primitive
-		value* clone();
+		inline value* clone() {
+			return new value(copy());
+		}
 
 		int hash();
 
+	private:
+		int compare_objects(value* b);
+
+		//copies the active union member of another value
+		inline void copy_payload(const value& other) {
+			if (other.type == VALUE_TYPE_NUMERICAL)
+				this->numerical = other.numerical;
+			else if (other.type == VALUE_TYPE_CHAR)
+				this->character = other.character;
+			else
+				this->ptr = other.ptr;
+		}
+
+	public:
+
+		//compares two values, returning zero if they're equal, and otherwise a negative or positive number to order them
+		//numericals and chars are compared inline, collections and structures are compared structurally, stopping at the first difference
 		inline int compare(value* b) {
-			if (this->type == VALUE_TYPE_NULL)
-				return b->type == VALUE_TYPE_NULL ? 0 : 1;
-			else if (b->type == VALUE_TYPE_NULL)
-				return this->type == VALUE_TYPE_NULL ? 0 : 1;
-			return this->hash() - b->hash();
+			if (this->type == VALUE_TYPE_NUMERICAL && b->type == VALUE_TYPE_NUMERICAL)
+				return (this->numerical > b->numerical) - (this->numerical < b->numerical);
+			else if (this->type == VALUE_TYPE_CHAR && b->type == VALUE_TYPE_CHAR)
+				return this->character - b->character;
+			return compare_objects(b);
 		}
 
-		//gets the ptr as numerical if ptr is a numerical
+		//gets the inline numerical if value is a numerical
 		inline long double* get_numerical() {
-			return (long double*)ptr;
+			return &numerical;
 		}
 
 		inline bool is_primitive() {
 			return this->type < VALUE_TYPE_COLLECTION;
 		}
 
-		//gets the ptr as char if ptr is a char
+		//gets the inline char if value is a char
 		inline char* get_char() {
-			return (char*)ptr;
+			return &character;
 		}
 	};
 }
@@ -3,102 +3,95 @@
 #ifndef VARIABLE_H
 #define VARIABLE_H
 
-#include "tokens.h"
+#include <vector>
 #include "errors.h"
 #include "value.h"
 #include "references.h"
 #include "garbage.h"
 
-#define VARIABLE_HASH_BUCKET_SIZE 100
-
 namespace fastcode {
 	namespace runtime {
+		//stores variables in slots assigned at compile time; an empty slot is an undeclared variable
 		class variable_manager {
 		private:
-			class variable_bucket {
-			public:
-				unsigned long id_hash;
-				reference_apartment* apartment;
-				variable_bucket(unsigned long id_hash, reference_apartment* apartment, variable_bucket* next_bucket = nullptr);
-				variable_bucket* next_bucket;
-			};
-
-			unsigned int size;
+			std::vector<reference_apartment*> slots;
 			garbage_collector* garbage_collector;
-			variable_bucket* hash_buckets[VARIABLE_HASH_BUCKET_SIZE];
 
 		public:
-			variable_manager(class garbage_collector* garbage_collector);
-			~variable_manager();
+			variable_manager(class garbage_collector* garbage_collector, unsigned int size = 0);
 
-			//declares a variable with a value
-			inline reference_apartment* declare_var(unsigned long id_hash, value* value) {
-				return declare_var(id_hash, garbage_collector->new_apartment(value));
+			//grows the manager so it has atleast size slots
+			inline void expand(unsigned int size) {
+				if (size > slots.size())
+					slots.resize(size, nullptr);
 			}
 
-			//declares a variable with a value
-			inline reference_apartment* declare_var(parsing::identifier_token* identifier, value* value) {
-				return declare_var(identifier->id_hash, value);
+			//preallocates room for capacity slots, so frames can be pushed without reallocating
+			inline void reserve(unsigned int capacity) {
+				slots.reserve(capacity);
 			}
 
-			//declares a variable with a reference
-			reference_apartment* declare_var(unsigned long id_hash, reference_apartment* reference);
+			//marks every declared variable as alive
+			void mark();
 
-			//declares a variable with a reference
-			inline reference_apartment* declare_var(parsing::identifier_token* identifier, reference_apartment* reference) {
-				return declare_var(identifier->id_hash, reference);
+			//carves a frame of empty slots off the top of the manager, returns the frame's base slot
+			inline unsigned int push_frame(unsigned int size) {
+				unsigned int base = (unsigned int)slots.size();
+				slots.resize(base + size, nullptr);
+				return base;
 			}
 
-			//removes a variable
-			void remove_var(unsigned long id_hash);
-
-			//removes a variable
-			inline void remove_var(parsing::identifier_token* identifier) {
-				remove_var(identifier->id_hash);
+			//removes every variable from the base slot upwards, and shrinks the manager back down to it
+			inline void pop_frame(unsigned int base) {
+				slots.resize(base);
 			}
 
-			//checks whether a variable exists
-			bool has_var(unsigned long id_hash);
+			//declares a variable with a value
+			inline reference_apartment* declare_var(unsigned int slot, value* value) {
+				return declare_var(slot, garbage_collector->new_apartment(value));
+			}
 
-			//checks whether a variable exists
-			inline bool has_var(parsing::identifier_token* identifier) {
-				return has_var(identifier->id_hash);
+			//declares a variable with a reference
+			inline reference_apartment* declare_var(unsigned int slot, reference_apartment* reference) {
+				if (slots[slot] != nullptr)
+					throw ERROR_VARIABLE_ALREADY_DEFINED;
+				return slots[slot] = reference;
 			}
 
-			//sets a variable to a reference
-			void set_var_reference(unsigned long id_hash, reference_apartment* reference);
+			//removes a variable
+			inline void remove_var(unsigned int slot) {
+				if (slots[slot] == nullptr)
+					throw ERROR_VARIABLE_NOT_DEFINED;
+				slots[slot] = nullptr;
+			}
 
-			//sets a variable to a reference
-			inline void set_var_reference(parsing::identifier_token* identifier, reference_apartment* reference) {
-				set_var_reference(identifier->id_hash, reference);
+			//checks whether a variable exists
+			inline bool has_var(unsigned int slot) {
+				return slots[slot] != nullptr;
 			}
 
-			//sets a variable to a value
-			inline void set_var_value(unsigned long id_hash, value* value) {
-				get_var_reference(id_hash)->set_value(value);
+			//sets a variable to a reference
+			inline void set_var_reference(unsigned int slot, reference_apartment* reference) {
+				if (slots[slot] == nullptr)
+					throw ERROR_VARIABLE_NOT_DEFINED;
+				slots[slot] = reference;
 			}
 
 			//sets a variable to a value
-			inline void set_var_value(parsing::identifier_token* identifier, value* value) {
-				get_var_reference(identifier->id_hash)->set_value(value);
+			inline void set_var_value(unsigned int slot, value* value) {
+				get_var_reference(slot)->set_value(value);
 			}
 
 			//gets a variable's reference
-			reference_apartment* get_var_reference(unsigned long id_hash);
-
-			//gets a variable's reference
-			inline reference_apartment* get_var_reference(parsing::identifier_token* identifier) {
-				return get_var_reference(identifier->id_hash);
-			}
-
-			//gets a variable's value
-			inline value* get_var_value(unsigned long id_hash) {
-				return get_var_reference(id_hash)->value;
+			inline reference_apartment* get_var_reference(unsigned int slot) {
+				if (slots[slot] == nullptr)
+					throw ERROR_VARIABLE_NOT_DEFINED;
+				return slots[slot];
 			}
 
 			//gets a variable's value
-			inline value* get_var_value(parsing::identifier_token* identifier) {
-				return get_var_reference(identifier->id_hash)->value;
+			inline value* get_var_value(unsigned int slot) {
+				return get_var_reference(slot)->value;
 			}
 		};
 	}
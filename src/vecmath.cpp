@@ -0,0 +1,244 @@
+#include <cmath>
+#include "builtins.h"
+#include "vecmath.h"
+
+namespace fastcode {
+	namespace builtins {
+		namespace vecmath {
+			//gathers a collection of numbers into a contiguous buffer, without boxing packed collections
+			static void gather(value* value, std::vector<long double>& numbers) {
+				if (value->type != VALUE_TYPE_COLLECTION)
+					throw ERROR_MUST_HAVE_COLLECTION_TYPE;
+				runtime::collection* collection = (runtime::collection*)value->ptr;
+				if (collection->get_string() != nullptr && collection->size > 0)
+					throw ERROR_MUST_HAVE_NUM_TYPE;
+				numbers.resize(collection->size);
+				for (unsigned long i = 0; i < collection->size; i++) {
+					class value* element = collection->get_value(i);
+					if (element->type != VALUE_TYPE_NUMERICAL)
+						throw ERROR_MUST_HAVE_NUM_TYPE;
+					numbers[i] = *element->get_numerical();
+				}
+			}
+
+			//gathers an operand of an elementwise operator, a number is repeated for every element
+			static void gather_operand(value* value, unsigned long size, std::vector<long double>& numbers) {
+				if (value->type == VALUE_TYPE_NUMERICAL) {
+					numbers.assign(size, *value->get_numerical());
+					return;
+				}
+				gather(value, numbers);
+				if (numbers.size() != size)
+					throw ERROR_INDEX_OUT_OF_RANGE;
+			}
+
+			static runtime::reference_apartment* scatter(const std::vector<long double>& numbers, runtime::garbage_collector* gc) {
+				runtime::collection* result = new runtime::collection((unsigned long)numbers.size(), gc);
+				for (unsigned long i = 0; i < numbers.size(); i++) {
+					value number(numbers[i]);
+					result->set_primitive(i, &number);
+				}
+				return result->get_parent_ref();
+			}
+
+			//the kernels only see plain arrays, so the compiler is free to unroll and vectorize them
+			static void add_kernel(const long double* a, const long double* b, long double* out, unsigned long size) {
+				for (unsigned long i = 0; i < size; i++)
+					out[i] = a[i] + b[i];
+			}
+
+			static void subtract_kernel(const long double* a, const long double* b, long double* out, unsigned long size) {
+				for (unsigned long i = 0; i < size; i++)
+					out[i] = a[i] - b[i];
+			}
+
+			static void multiply_kernel(const long double* a, const long double* b, long double* out, unsigned long size) {
+				for (unsigned long i = 0; i < size; i++)
+					out[i] = a[i] * b[i];
+			}
+
+			static void divide_kernel(const long double* a, const long double* b, long double* out, unsigned long size) {
+				for (unsigned long i = 0; i < size; i++)
+					out[i] = a[i] / b[i];
+			}
+
+			//reductions keep four independent accumulators, so consecutive additions don't wait on each other
+			static long double sum_kernel(const long double* a, unsigned long size) {
+				long double s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+				unsigned long i = 0;
+				for (; i + 4 <= size; i += 4) {
+					s0 += a[i];
+					s1 += a[i + 1];
+					s2 += a[i + 2];
+					s3 += a[i + 3];
+				}
+				for (; i < size; i++)
+					s0 += a[i];
+				return (s0 + s1) + (s2 + s3);
+			}
+
+			static long double dot_kernel(const long double* a, const long double* b, unsigned long size) {
+				long double s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+				unsigned long i = 0;
+				for (; i + 4 <= size; i += 4) {
+					s0 += a[i] * b[i];
+					s1 += a[i + 1] * b[i + 1];
+					s2 += a[i + 2] * b[i + 2];
+					s3 += a[i + 3] * b[i + 3];
+				}
+				for (; i < size; i++)
+					s0 += a[i] * b[i];
+				return (s0 + s1) + (s2 + s3);
+			}
+
+			static long double min_kernel(const long double* a, unsigned long size) {
+				long double m = a[0];
+				for (unsigned long i = 1; i < size; i++)
+					m = a[i] < m ? a[i] : m;
+				return m;
+			}
+
+			static long double max_kernel(const long double* a, unsigned long size) {
+				long double m = a[0];
+				for (unsigned long i = 1; i < size; i++)
+					m = a[i] > m ? a[i] : m;
+				return m;
+			}
+
+			static runtime::reference_apartment* elementwise(const std::vector<value*>& arguments, runtime::garbage_collector* gc, void (*kernel)(const long double*, const long double*, long double*, unsigned long), bool divides) {
+				match_arg_len(arguments, 2);
+				if (arguments[0]->type != VALUE_TYPE_COLLECTION && arguments[1]->type != VALUE_TYPE_COLLECTION)
+					throw ERROR_MUST_HAVE_COLLECTION_TYPE;
+				unsigned long size = ((runtime::collection*)(arguments[0]->type == VALUE_TYPE_COLLECTION ? arguments[0] : arguments[1])->ptr)->size;
+
+				std::vector<long double> a, b;
+				gather_operand(arguments[0], size, a);
+				gather_operand(arguments[1], size, b);
+				if (divides)
+					for (unsigned long i = 0; i < size; i++)
+						if (b[i] == 0)
+							throw ERROR_DIVIDE_BY_ZERO;
+				std::vector<long double> result(size);
+				kernel(a.data(), b.data(), result.data(), size);
+				return scatter(result, gc);
+			}
+
+			static runtime::reference_apartment* map(const std::vector<value*>& arguments, runtime::garbage_collector* gc, long double (*function)(long double)) {
+				match_arg_len(arguments, 1);
+				std::vector<long double> numbers;
+				gather(arguments[0], numbers);
+				for (unsigned long i = 0; i < numbers.size(); i++)
+					numbers[i] = function(numbers[i]);
+				return scatter(numbers, gc);
+			}
+
+			runtime::reference_apartment* add(const std::vector<value*>& arguments, runtime::garbage_collector* gc) {
+				return elementwise(arguments, gc, add_kernel, false);
+			}
+
+			runtime::reference_apartment* subtract(const std::vector<value*>& arguments, runtime::garbage_collector* gc) {
+				return elementwise(arguments, gc, subtract_kernel, false);
+			}
+
+			runtime::reference_apartment* multiply(const std::vector<value*>& arguments, runtime::garbage_collector* gc) {
+				return elementwise(arguments, gc, multiply_kernel, false);
+			}
+
+			runtime::reference_apartment* divide(const std::vector<value*>& arguments, runtime::garbage_collector* gc) {
+				return elementwise(arguments, gc, divide_kernel, true);
+			}
+
+			runtime::reference_apartment* sum(const std::vector<value*>& arguments, runtime::garbage_collector* gc) {
+				match_arg_len(arguments, 1);
+				std::vector<long double> numbers;
+				gather(arguments[0], numbers);
+				return gc->new_apartment(new value(sum_kernel(numbers.data(), (unsigned long)numbers.size())));
+			}
+
+			runtime::reference_apartment* min(const std::vector<value*>& arguments, runtime::garbage_collector* gc) {
+				match_arg_len(arguments, 1);
+				std::vector<long double> numbers;
+				gather(arguments[0], numbers);
+				if (numbers.empty())
+					throw ERROR_INDEX_OUT_OF_RANGE;
+				return gc->new_apartment(new value(min_kernel(numbers.data(), (unsigned long)numbers.size())));
+			}
+
+			runtime::reference_apartment* max(const std::vector<value*>& arguments, runtime::garbage_collector* gc) {
+				match_arg_len(arguments, 1);
+				std::vector<long double> numbers;
+				gather(arguments[0], numbers);
+				if (numbers.empty())
+					throw ERROR_INDEX_OUT_OF_RANGE;
+				return gc->new_apartment(new value(max_kernel(numbers.data(), (unsigned long)numbers.size())));
+			}
+
+			runtime::reference_apartment* dot(const std::vector<value*>& arguments, runtime::garbage_collector* gc) {
+				match_arg_len(arguments, 2);
+				std::vector<long double> a, b;
+				gather(arguments[0], a);
+				gather(arguments[1], b);
+				if (a.size() != b.size())
+					throw ERROR_INDEX_OUT_OF_RANGE;
+				return gc->new_apartment(new value(dot_kernel(a.data(), b.data(), (unsigned long)a.size())));
+			}
+
+			runtime::reference_apartment* prefix_sum(const std::vector<value*>& arguments, runtime::garbage_collector* gc) {
+				match_arg_len(arguments, 1);
+				std::vector<long double> numbers;
+				gather(arguments[0], numbers);
+				for (unsigned long i = 1; i < numbers.size(); i++)
+					numbers[i] += numbers[i - 1];
+				return scatter(numbers, gc);
+			}
+
+			static long double abs_function(long double x) {
+				return std::abs(x);
+			}
+
+			static long double sqrt_function(long double x) {
+				return std::sqrt(x);
+			}
+
+			static long double exp_function(long double x) {
+				return std::exp(x);
+			}
+
+			static long double log_function(long double x) {
+				return std::log(x);
+			}
+
+			static long double sin_function(long double x) {
+				return std::sin(x);
+			}
+
+			static long double cos_function(long double x) {
+				return std::cos(x);
+			}
+
+			runtime::reference_apartment* abs(const std::vector<value*>& arguments, runtime::garbage_collector* gc) {
+				return map(arguments, gc, abs_function);
+			}
+
+			runtime::reference_apartment* sqrt(const std::vector<value*>& arguments, runtime::garbage_collector* gc) {
+				return map(arguments, gc, sqrt_function);
+			}
+
+			runtime::reference_apartment* exp(const std::vector<value*>& arguments, runtime::garbage_collector* gc) {
+				return map(arguments, gc, exp_function);
+			}
+
+			runtime::reference_apartment* log(const std::vector<value*>& arguments, runtime::garbage_collector* gc) {
+				return map(arguments, gc, log_function);
+			}
+
+			runtime::reference_apartment* sin(const std::vector<value*>& arguments, runtime::garbage_collector* gc) {
+				return map(arguments, gc, sin_function);
+			}
+
+			runtime::reference_apartment* cos(const std::vector<value*>& arguments, runtime::garbage_collector* gc) {
+				return map(arguments, gc, cos_function);
+			}
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,39 @@
+#pragma once
+
+#ifndef VECMATH_H
+#define VECMATH_H
+
+#include <vector>
+#include "garbage.h"
+#include "references.h"
+#include "value.h"
+
+namespace fastcode {
+	namespace builtins {
+		//batch math over whole collections of numbers, gathered into contiguous buffers and ran through tight kernels
+		namespace vecmath {
+			//elementwise arithmetic, either operand may be a number that's applied to every element
+			runtime::reference_apartment* add(const std::vector<value*>& arguments, runtime::garbage_collector* gc);
+			runtime::reference_apartment* subtract(const std::vector<value*>& arguments, runtime::garbage_collector* gc);
+			runtime::reference_apartment* multiply(const std::vector<value*>& arguments, runtime::garbage_collector* gc);
+			runtime::reference_apartment* divide(const std::vector<value*>& arguments, runtime::garbage_collector* gc);
+
+			//reductions
+			runtime::reference_apartment* sum(const std::vector<value*>& arguments, runtime::garbage_collector* gc);
+			runtime::reference_apartment* min(const std::vector<value*>& arguments, runtime::garbage_collector* gc);
+			runtime::reference_apartment* max(const std::vector<value*>& arguments, runtime::garbage_collector* gc);
+			runtime::reference_apartment* dot(const std::vector<value*>& arguments, runtime::garbage_collector* gc);
+			runtime::reference_apartment* prefix_sum(const std::vector<value*>& arguments, runtime::garbage_collector* gc);
+
+			//elementwise functions
+			runtime::reference_apartment* abs(const std::vector<value*>& arguments, runtime::garbage_collector* gc);
+			runtime::reference_apartment* sqrt(const std::vector<value*>& arguments, runtime::garbage_collector* gc);
+			runtime::reference_apartment* exp(const std::vector<value*>& arguments, runtime::garbage_collector* gc);
+			runtime::reference_apartment* log(const std::vector<value*>& arguments, runtime::garbage_collector* gc);
+			runtime::reference_apartment* sin(const std::vector<value*>& arguments, runtime::garbage_collector* gc);
+			runtime::reference_apartment* cos(const std::vector<value*>& arguments, runtime::garbage_collector* gc);
+		}
+	}
+}
+
+#endif // !VECMATH_H
\ No newline at end of file